@@ -1,6 +1,7 @@
 // Copyright (c) 2015-2015 Josh Blum
 // SPDX-License-Identifier: BSL-1.0
 
+#pragma once
 #include <Pothos/Config.hpp>
 #include <cstddef> //size_t
 #include <cstdint>
@@ -8,6 +9,12 @@
 //! The exact number of bits when header fields are encoded
 #define NUM_HEADER_BITS (2 + (8+12+8)*2)
 
+//! The exact number of bits when extended header fields are encoded
+#define NUM_EXT_HEADER_BITS (2 + (4+8+24+16+16)*2)
+
+//! The version number encoded into the extended header
+#define EXT_HEADER_VERSION 1
+
 //percent of sync word to declare peak found
 static const double CORR_MAG_PERCENT = 0.7;
 static const double CORR_DUR_PERCENT = 0.5;
@@ -26,6 +33,24 @@ static inline uint8_t checksum8(const uint8_t *p, const size_t len)
     return acc;
 }
 
+/***********************************************************************
+ * CRC-16-CCITT routine for the extended header
+ * https://en.wikipedia.org/wiki/Cyclic_redundancy_check
+ **********************************************************************/
+static inline uint16_t crc16(const uint8_t *p, const size_t len)
+{
+    uint16_t crc = 0xffff;
+    for (size_t i = 0; i < len; i++)
+    {
+        crc ^= uint16_t(p[i]) << 8;
+        for (size_t j = 0; j < 8; j++)
+        {
+            crc = (crc & 0x8000)?((crc << 1) ^ 0x1021):(crc << 1);
+        }
+    }
+    return crc;
+}
+
 /***********************************************************************
  * Struct used for encoding header fields
  * These fields are encoded after the phase sync portion
@@ -33,15 +58,21 @@ static inline uint8_t checksum8(const uint8_t *p, const size_t len)
 struct FrameHeaderFields
 {
     FrameHeaderFields(void):
+        version(0),
         id(0),
         length(0),
+        seq(0),
         chksum(0),
+        crc(0),
         error(false)
     {}
 
+    uint8_t version; //extended header only
     uint8_t id;
-    uint16_t length;
+    uint32_t length; //12 bits, 24 bits in the extended header
+    uint16_t seq; //extended header only
     uint8_t chksum;
+    uint16_t crc; //extended header only
     bool error;
 
     uint8_t doChecksum(void) const
@@ -49,9 +80,22 @@ struct FrameHeaderFields
         uint8_t bytes[3];
         bytes[0] = id;
         bytes[1] = length & 0xff;
-        bytes[2] = length >> 8;
+        bytes[2] = (length >> 8) & 0xff;
         return checksum8(bytes, sizeof(bytes));
     }
+
+    uint16_t doCrc(void) const
+    {
+        uint8_t bytes[7];
+        bytes[0] = version;
+        bytes[1] = id;
+        bytes[2] = length & 0xff;
+        bytes[3] = (length >> 8) & 0xff;
+        bytes[4] = (length >> 16) & 0xff;
+        bytes[5] = seq & 0xff;
+        bytes[6] = seq >> 8;
+        return crc16(bytes, sizeof(bytes));
+    }
 };
 
 /***********************************************************************
@@ -170,3 +214,62 @@ static inline void decodeHeaderWord(const char *bits, FrameHeaderFields &hdr)
     hdr.chksum |= uint8_t(decodeHamming84(bits+40, hdr.error)) << 0;
     hdr.chksum |= uint8_t(decodeHamming84(bits+48, hdr.error)) << 4;
 }
+
+/***********************************************************************
+ * Encode extended header data fields into a bit-buffer
+ * The version field distinguishes future header formats
+ **********************************************************************/
+static inline void encodeExtHeaderWord(char *bits, const FrameHeaderFields &hdr)
+{
+    //insert time sync
+    *bits++ = 0;
+    *bits++ = 1;
+
+    //encode version
+    encodeHamming84(hdr.version, bits);
+    bits += 8;
+
+    //encode id
+    for (size_t i = 0; i < 8; i += 4, bits += 8) encodeHamming84(hdr.id >> i, bits);
+
+    //encode length
+    for (size_t i = 0; i < 24; i += 4, bits += 8) encodeHamming84(hdr.length >> i, bits);
+
+    //encode sequence
+    for (size_t i = 0; i < 16; i += 4, bits += 8) encodeHamming84(hdr.seq >> i, bits);
+
+    //encode crc
+    for (size_t i = 0; i < 16; i += 4, bits += 8) encodeHamming84(hdr.crc >> i, bits);
+}
+
+/***********************************************************************
+ * Decode extended header data fields from a bit-buffer
+ * The caller checks the version and the crc of the decoded fields
+ **********************************************************************/
+static inline void decodeExtHeaderWord(const char *bits, FrameHeaderFields &hdr)
+{
+    hdr.error = false;
+
+    //skip time sync
+    bits+=2;
+
+    //decode version
+    hdr.version = uint8_t(decodeHamming84(bits, hdr.error));
+    bits += 8;
+
+    //decode id
+    hdr.id = 0;
+    for (size_t i = 0; i < 8; i += 4, bits += 8) hdr.id |= uint8_t(decodeHamming84(bits, hdr.error)) << i;
+
+    //decode length
+    hdr.length = 0;
+    for (size_t i = 0; i < 24; i += 4, bits += 8) hdr.length |= uint32_t(decodeHamming84(bits, hdr.error)) << i;
+
+    //decode sequence
+    hdr.seq = 0;
+    for (size_t i = 0; i < 16; i += 4, bits += 8) hdr.seq |= uint16_t(decodeHamming84(bits, hdr.error)) << i;
+
+    //decode crc
+    hdr.crc = 0;
+    for (size_t i = 0; i < 16; i += 4, bits += 8) hdr.crc |= uint16_t(decodeHamming84(bits, hdr.error)) << i;
+}
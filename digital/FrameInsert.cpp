@@ -8,6 +8,12 @@
 #include <algorithm> //min/max
 #include <complex>
 #include <cstdint>
+#include <string>
+#include <map>
+#include <deque>
+
+//maximum number of encoded preamble buffers cached by length
+static const size_t PREAMBLE_CACHE_SIZE = 16;
 
 /***********************************************************************
  * |PothosDoc Frame Insert
@@ -30,6 +36,26 @@
  * will be shifted to the last symbol of the padding buffer.
  * All other labels propagate with the same position.
  *
+ * <h2>Packet mode</h2>
+ *
+ * The Frame Insert block also accepts packet messages on the input port.
+ * Each packet payload is written with the preamble, header, and padding
+ * into one contiguous output buffer, which is produced as a burst on the output stream.
+ * The burst is marked with a frame start label on the first element of the header,
+ * and a frame end label on the last element of the padding (when the label ID is specified).
+ * The label data is the payload length in elements, as encoded into the header.
+ * Packet labels are forwarded with the same position relative to the payload.
+ * The payload type must match the data type of the block,
+ * and the payload length must fit into the length field of the header format.
+ *
+ * <h2>Header format</h2>
+ *
+ * The standard header encodes an 8-bit ID, a 12-bit length, and an 8-bit checksum,
+ * which limits the payload to 4095 symbols.
+ * The extended header encodes a version number, an 8-bit ID, a 24-bit length,
+ * a 16-bit sequence number that increments with each frame, and a 16-bit CRC.
+ * The Frame Sync in the receiver must be configured with the same header format.
+ *
  * |category /Digital
  * |keywords preamble frame sync
  * |alias /blocks/frame_insert
@@ -50,6 +76,12 @@
  * The frame sync at the receiver uses this ID to reject unrecognized frames.
  * |default 0x55
  *
+ * |param headerFormat[Header Format] The format of the encoded frame header.
+ * |default "STANDARD"
+ * |option [Standard] "STANDARD"
+ * |option [Extended] "EXTENDED"
+ * |preview valid
+ *
  * |param symbolWidth [Symbol Width] The number of samples per preamble symbol.
  * Each symbol in the preamble will be duplicated by the specified symbol width.
  * Note: this is not the same as the samples per symbol used in data modulation,
@@ -73,6 +105,7 @@
  * |factory /comms/frame_insert(dtype)
  * |setter setPreamble(preamble)
  * |setter setHeaderId(headerId)
+ * |setter setHeaderFormat(headerFormat)
  * |setter setSymbolWidth(symbolWidth)
  * |setter setFrameStartId(frameStartId)
  * |setter setFrameEndId(frameEndId)
@@ -89,6 +122,9 @@ public:
 
     FrameInsert(void):
         _headerId(0),
+        _extendedHeader(false),
+        _numHeaderBits(NUM_HEADER_BITS),
+        _sequence(0),
         _symbolWidth(0),
         _syncWordWidth(0)
     {
@@ -98,6 +134,8 @@ public:
         this->registerCall(this, POTHOS_FCN_TUPLE(FrameInsert, getPreamble));
         this->registerCall(this, POTHOS_FCN_TUPLE(FrameInsert, setHeaderId));
         this->registerCall(this, POTHOS_FCN_TUPLE(FrameInsert, getHeaderId));
+        this->registerCall(this, POTHOS_FCN_TUPLE(FrameInsert, setHeaderFormat));
+        this->registerCall(this, POTHOS_FCN_TUPLE(FrameInsert, getHeaderFormat));
         this->registerCall(this, POTHOS_FCN_TUPLE(FrameInsert, setSymbolWidth));
         this->registerCall(this, POTHOS_FCN_TUPLE(FrameInsert, getSymbolWidth));
         this->registerCall(this, POTHOS_FCN_TUPLE(FrameInsert, setFrameStartId));
@@ -108,6 +146,7 @@ public:
         this->registerCall(this, POTHOS_FCN_TUPLE(FrameInsert, getPaddingSize));
 
         this->setHeaderId(0x55); //initial update
+        this->setHeaderFormat("STANDARD"); //initial update
         this->setSymbolWidth(20); //initial update
         this->setPreamble(std::vector<Type>(1, 1)); //initial update
         this->setFrameStartId("frameStart"); //initial update
@@ -129,6 +168,7 @@ public:
     void setHeaderId(const unsigned char id)
     {
         _headerId = id;
+        this->clearPreambleCache();
     }
 
     unsigned char getHeaderId(void) const
@@ -136,6 +176,20 @@ public:
         return _headerId;
     }
 
+    void setHeaderFormat(const std::string &format)
+    {
+        if (format == "STANDARD") _extendedHeader = false;
+        else if (format == "EXTENDED") _extendedHeader = true;
+        else throw Pothos::InvalidArgumentException("FrameInsert::setHeaderFormat()", "unknown format: " + format);
+        _numHeaderBits = _extendedHeader?NUM_EXT_HEADER_BITS:NUM_HEADER_BITS;
+        this->updatePreambleBuffer();
+    }
+
+    std::string getHeaderFormat(void) const
+    {
+        return _extendedHeader?"EXTENDED":"STANDARD";
+    }
+
     void setSymbolWidth(const size_t width)
     {
         if (width == 0) throw Pothos::InvalidArgumentException("FrameInsert::setSymbolWidth()", "symbol width cannot be 0");
@@ -179,12 +233,71 @@ public:
         return _paddingBuff.elements();
     }
 
+    void activate(void)
+    {
+        _sequence = 0;
+    }
+
+    void msgWork(const Pothos::Packet &inPkt)
+    {
+        auto outputPort = this->output(0);
+        const size_t payloadElems = inPkt.payload.length/sizeof(Type);
+
+        //the payload must be of the stream type and fit the header length field
+        if (not (inPkt.payload.dtype == outputPort->dtype())) throw Pothos::InvalidArgumentException(
+            "FrameInsert::msgWork()", "payload type " + inPkt.payload.dtype.toString() + ", expected " + outputPort->dtype().toString());
+        const size_t maxLength = _extendedHeader?0xffffff:0xfff;
+        if (payloadElems > maxLength) throw Pothos::RangeException("FrameInsert::msgWork()",
+            "payload length " + std::to_string(payloadElems) + " exceeds the header maximum " + std::to_string(maxLength));
+
+        //the header length field is the payload size
+        FrameHeaderFields headerFields;
+        headerFields.id = _headerId;
+        headerFields.length = payloadElems;
+        const Pothos::BufferChunk preambleBuff = this->getPreambleBuffer(headerFields);
+
+        //write the entire burst into one contiguous output buffer
+        Pothos::BufferChunk outBuff = outputPort->getBuffer(preambleBuff.elements()+payloadElems+_paddingBuff.elements());
+        auto p = outBuff.as<char *>();
+        std::memcpy(p, preambleBuff.as<const void *>(), preambleBuff.length);
+        p += preambleBuff.length;
+        std::memcpy(p, inPkt.payload.as<const void *>(), payloadElems*sizeof(Type));
+        p += payloadElems*sizeof(Type);
+        std::memcpy(p, _paddingBuff.as<const void *>(), _paddingBuff.length);
+
+        //label the start and end of the burst
+        if (not _frameStartId.empty()) outputPort->postLabel(
+            _frameStartId, payloadElems, 0);
+        if (not _frameEndId.empty()) outputPort->postLabel(
+            _frameEndId, payloadElems, outBuff.elements()-1);
+
+        //forward packet labels relative to the payload
+        for (const auto &label : inPkt.labels)
+        {
+            Pothos::Label outLabel(label);
+            outLabel.index += preambleBuff.elements();
+            outputPort->postLabel(std::move(outLabel));
+        }
+
+        outputPort->postBuffer(std::move(outBuff));
+    }
+
     void work(void)
     {
         auto inputPort = this->input(0);
         auto outputPort = this->output(0);
         size_t consumed = 0;
 
+        //handle packet bursts if applicable
+        if (inputPort->hasMessage())
+        {
+            auto msg = inputPort->popMessage();
+            if (msg.type() == typeid(Pothos::Packet))
+                this->msgWork(msg.extract<Pothos::Packet>());
+            else outputPort->postMessage(std::move(msg));
+            return; //output buffer used, return now
+        }
+
         //get input buffer
         auto inBuff = inputPort->takeBuffer();
         if (inBuff.length == 0) return;
@@ -217,13 +330,7 @@ public:
                 headBuff.length = headElems*sizeof(Type);
                 if (headBuff.length != 0) outputPort->postBuffer(headBuff);
 
-                //fill the preamble buffer
-                Pothos::BufferChunk newPreambleBuff(typeid(Type), _preambleBuff.elements());
-                std::memcpy(newPreambleBuff.as<void *>(), _preambleBuff.as<const void *>(), _preambleBuff.length);
-                auto p = newPreambleBuff.as<Type *>() + _syncWordWidth;
-
-                //encode the header field into bits
-                char headerBits[NUM_HEADER_BITS];
+                //the header fields for this frame
                 FrameHeaderFields headerFields;
                 headerFields.id = _headerId;
                 headerFields.length = 0;
@@ -231,18 +338,9 @@ public:
                 {
                     headerFields.length = label.data.template convert<size_t>()*label.width;
                 }
-                headerFields.chksum = headerFields.doChecksum();
-                encodeHeaderWord(headerBits, headerFields);
-
-                //encode header fields as BPSK into the preamble buffer
-                const auto sym = _preamble.back();
-                for (size_t i = 0; i < NUM_HEADER_BITS; i++)
-                {
-                    *p++ = (headerBits[i] != 0)?+sym:-sym;
-                }
 
                 //post the preamble buffer
-                outputPort->postBuffer(newPreambleBuff);
+                outputPort->postBuffer(this->getPreambleBuffer(headerFields));
 
                 //remove header from the remaining buffer
                 inBuff.length -= headBuff.length;
@@ -293,10 +391,68 @@ public:
 
 private:
 
+    //Get a preamble buffer with the encoded header fields.
+    //The standard header only depends on the length (the ID is fixed),
+    //so recently used buffers are cached and posted again by reference.
+    //The extended header encodes a unique sequence number for each frame.
+    Pothos::BufferChunk getPreambleBuffer(FrameHeaderFields &headerFields)
+    {
+        if (not _extendedHeader)
+        {
+            auto it = _preambleCache.find(headerFields.length);
+            if (it != _preambleCache.end()) return it->second;
+        }
+
+        //fill the preamble buffer
+        Pothos::BufferChunk newPreambleBuff(typeid(Type), _preambleBuff.elements());
+        std::memcpy(newPreambleBuff.as<void *>(), _preambleBuff.as<const void *>(), _preambleBuff.length);
+        auto p = newPreambleBuff.as<Type *>() + _syncWordWidth;
+
+        //encode the header field into bits
+        char headerBits[NUM_EXT_HEADER_BITS];
+        if (_extendedHeader)
+        {
+            headerFields.version = EXT_HEADER_VERSION;
+            headerFields.seq = _sequence++;
+            headerFields.crc = headerFields.doCrc();
+            encodeExtHeaderWord(headerBits, headerFields);
+        }
+        else
+        {
+            headerFields.chksum = headerFields.doChecksum();
+            encodeHeaderWord(headerBits, headerFields);
+        }
+
+        //encode header fields as BPSK into the preamble buffer
+        const auto sym = _preamble.back();
+        for (size_t i = 0; i < _numHeaderBits; i++)
+        {
+            *p++ = (headerBits[i] != 0)?+sym:-sym;
+        }
+        if (_extendedHeader) return newPreambleBuff;
+
+        //cache the buffer, evict the oldest entry when full
+        if (_preambleCache.size() >= PREAMBLE_CACHE_SIZE)
+        {
+            _preambleCache.erase(_preambleCacheOrder.front());
+            _preambleCacheOrder.pop_front();
+        }
+        _preambleCache[headerFields.length] = newPreambleBuff;
+        _preambleCacheOrder.push_back(headerFields.length);
+        return newPreambleBuff;
+    }
+
+    void clearPreambleCache(void)
+    {
+        _preambleCache.clear();
+        _preambleCacheOrder.clear();
+    }
+
     void updatePreambleBuffer(void)
     {
+        this->clearPreambleCache();
         _syncWordWidth = _symbolWidth*_preamble.size();
-        _preambleBuff = Pothos::BufferChunk(typeid(Type), _syncWordWidth+NUM_HEADER_BITS);
+        _preambleBuff = Pothos::BufferChunk(typeid(Type), _syncWordWidth+_numHeaderBits);
 
         auto p = _preambleBuff.as<Type *>();
         std::memset(p, 0, _preambleBuff.length);
@@ -313,10 +469,15 @@ private:
     std::string _frameEndId;
     std::vector<Type> _preamble;
     unsigned char _headerId;
+    bool _extendedHeader;
+    size_t _numHeaderBits;
+    uint16_t _sequence;
     size_t _symbolWidth;
     size_t _syncWordWidth;
     Pothos::BufferChunk _preambleBuff;
     Pothos::BufferChunk _paddingBuff;
+    std::map<uint32_t, Pothos::BufferChunk> _preambleCache; //encoded preamble buffers by length
+    std::deque<uint32_t> _preambleCacheOrder; //cached lengths in insertion order
 };
 
 /***********************************************************************
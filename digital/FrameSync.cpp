@@ -2,12 +2,29 @@
 // SPDX-License-Identifier: BSL-1.0
 
 #include "FrameHelper.hpp"
+#include "FxptHelpers.hpp"
 #include <Pothos/Framework.hpp>
+#include <Pothos/Util/QFormat.hpp>
 #include <cstring> //memcpy
 #include <iostream>
 #include <algorithm> //min/max
 #include <complex>
 #include <cstdint>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+using Pothos::Util::fromQ;
+using Pothos::Util::floatToQ;
+
+//fractional bits of the unit phasor used in the fixed point correlation
+static const int ROTATOR_Q_BITS = 14;
+
+//fractional bits of the unit amplitude in the fixed point payload output
+static const int PAYLOAD_Q_BITS = 13;
+
+//number of payload samples corrected for each evaluation of the phase
+static const size_t PAYLOAD_BLOCK_SIZE = 64;
 
 /***********************************************************************
  * |PothosDoc Frame Sync
@@ -38,6 +55,11 @@
  * A Costas loop may be used track carrier phase:<br />
  * <a href="https://en.wikipedia.org/wiki/Costas_loop">https://en.wikipedia.org/wiki/Costas_loop</a>
  *
+ * When the scale ID is specified, the raw payload is forwarded
+ * without copying as a slice of the input buffer, and without scaling.
+ * Instead, the amplitude scale is produced as a label at the first payload index,
+ * which may be used by a downstream gain stage to normalize the payload.
+ *
  * <h3>Phase compensation</h3>
  *
  * Using the discovered carrier frequency and phase offset,
@@ -56,12 +78,20 @@
  * The next downstream block may perform symbol detection
  * to remap the recovered symbols into data bits.
  *
+ * <h2>Fixed point</h2>
+ *
+ * The complex int16 data type searches for frames using integer accumulators,
+ * and estimates the frequency offset with a fixed point arctangent.
+ * The payload is produced as complex int16 in a Q format with 13 fractional bits,
+ * so a unit amplitude symbol has a magnitude of 8192.
+ * The input threshold is specified in raw input units for this data type.
+ *
  * |category /Digital
  * |keywords preamble frame sync timing offset recover
  * |alias /blocks/frame_sync
  *
  * |param dtype[Data Type] The input data type consumed by the slicer.
- * |widget DTypeChooser(cfloat=1)
+ * |widget DTypeChooser(cfloat=1,cint=1)
  * |default "complex_float32"
  * |preview disable
  *
@@ -85,6 +115,15 @@
  * The frame sync uses this ID to compare and to reject unrecognized frames.
  * |default 0x55
  *
+ * |param headerFormat[Header Format] The format of the frame header.
+ * This value should correspond to the header format used in the frame inserter block.
+ * The extended header supports payload lengths up to 24 bits,
+ * and carries a frame sequence number and a 16-bit CRC.
+ * |default "STANDARD"
+ * |option [Standard] "STANDARD"
+ * |option [Extended] "EXTENDED"
+ * |preview valid
+ *
  * |param symbolWidth [Symbol Width] The number of samples per preamble symbol.
  * This value should correspond to the symbol width used in the frame inserter block.
  * |default 20
@@ -121,6 +160,43 @@
  * |preview valid
  * |tab Labels
  *
+ * |param sequenceID[Sequence ID] The label ID used to forward the frame sequence number.
+ * The sequence label specifies the sequence number decoded from the extended header,
+ * and is produced at the first payload index to help detect lost frames downstream.
+ * The sequence label will not be produced when the label ID is not specified,
+ * or when the header format does not carry a sequence number.
+ * |default ""
+ * |widget StringEntry()
+ * |preview valid
+ * |tab Labels
+ *
+ * |param scaleID[Scale ID] The label ID used to forward the amplitude scale downstream.
+ * The scale label specifies the gain that normalizes the payload to unit amplitude.
+ * The scale label is only produced in raw output mode,
+ * and the raw payload is then forwarded without scaling (zero copy).
+ * The scale label will not be produced when the label ID is not specified.
+ * |default ""
+ * |widget StringEntry()
+ * |preview valid
+ * |tab Labels
+ *
+ * |param coarseSearch[Coarse Search] Search for frames in two stages to reduce the search cost.
+ * The first stage correlates boxcar sums over each data symbol width,
+ * stepping through the input at the data symbol rate to find candidate offsets.
+ * The second stage searches at the full sample rate only around those candidates.
+ * |default false
+ * |preview disable
+ * |option [Enable] true
+ * |option [Disable] false
+ *
+ * |param searchThreads[Search Threads] The number of threads used in the frame search.
+ * Large input buffers are split into segments which are searched in parallel,
+ * each segment overlapping the next by the width of the frame header.
+ * The default of 1 searches entirely within the block's work thread.
+ * |default 1
+ * |widget SpinBox(minimum=1)
+ * |preview disable
+ *
  * |param verboseMode[Verbose Mode] Enable debug verbose when frames are discovered.
  * |default false
  * |preview disable
@@ -131,18 +207,74 @@
  * |setter setOutputMode(outputMode)
  * |setter setPreamble(preamble)
  * |setter setHeaderId(headerId)
+ * |setter setHeaderFormat(headerFormat)
  * |setter setSymbolWidth(symbolWidth)
  * |setter setDataWidth(dataWidth)
  * |setter setFrameStartId(frameStartId)
  * |setter setFrameEndId(frameEndId)
  * |setter setPhaseOffsetID(phaseOffsetID)
+ * |setter setSequenceID(sequenceID)
+ * |setter setScaleID(scaleID)
  * |setter setInputThreshold(inputThreshold)
+ * |setter setCoarseSearch(coarseSearch)
+ * |setter setSearchThreads(searchThreads)
  * |setter setVerboseMode(verboseMode)
  **********************************************************************/
+template <typename Type>
+struct FrameSyncTypes
+{
+    typedef typename Type::value_type RealType; //frame calculations
+    typedef double AccRealType; //running sums
+    typedef Type CorrType; //correlation sums
+};
+
+template <>
+struct FrameSyncTypes<std::complex<int16_t>>
+{
+    typedef float RealType; //frame calculations
+    typedef int64_t AccRealType; //running sums
+    typedef std::complex<int64_t> CorrType; //correlation sums
+};
+
+template <typename RealType, typename InType>
+std::complex<RealType> toComplex(const std::complex<InType> &in)
+{
+    return std::complex<RealType>(RealType(in.real()), RealType(in.imag()));
+}
+
+/***********************************************************************
+ * Templated phase angle in radians for fixed and float support
+ **********************************************************************/
+template <typename Type>
+typename std::enable_if<std::is_floating_point<Type>::value, double>::type
+getPhase(const std::complex<Type> &in)
+{
+    return std::arg(in);
+}
+
+template <typename Type>
+typename std::enable_if<std::is_integral<Type>::value, double>::type
+getPhase(const std::complex<Type> &in)
+{
+    //normalize the sum into 16 bits for the fixed point arctangent
+    Type real = in.real(), imag = in.imag();
+    while (real > 32767 or real < -32767 or imag > 32767 or imag < -32767)
+    {
+        real /= 2;
+        imag /= 2;
+    }
+    const auto angle = int16_t(getAngle(std::complex<int16_t>(int16_t(real), int16_t(imag))));
+    return angle*(M_PI/32768);
+}
+
 template <typename Type>
 class FrameSync : public Pothos::Block
 {
-    typedef typename Type::value_type RealType;
+    typedef typename FrameSyncTypes<Type>::RealType RealType;
+    typedef std::complex<RealType> ComplexType;
+    typedef typename FrameSyncTypes<Type>::AccRealType AccRealType;
+    typedef std::complex<AccRealType> AccType;
+    typedef typename FrameSyncTypes<Type>::CorrType CorrType;
 
 public:
     static Block *make(void)
@@ -152,21 +284,31 @@ public:
 
     FrameSync(void):
         _headerId(0),
+        _extendedHeader(false),
+        _numHeaderBits(NUM_HEADER_BITS),
         _symbolWidth(0),
         _dataWidth(0),
         _syncWordWidth(0),
         _frameWidth(0),
         _inputThreshold(0),
-        _verbose(false)
+        _coarseSearch(false),
+        _searchThreads(1),
+        _verbose(false),
+        _searchIn(nullptr),
+        _nextSegment(0),
+        _segmentsDone(0),
+        _workersExit(false)
     {
         this->setupInput(0, typeid(Type));
-        this->setupOutput(0, typeid(Type));
+        this->setupOutput(0, typeid(Type), this->uid()); //unique domain because of buffer forwarding
         this->registerCall(this, POTHOS_FCN_TUPLE(FrameSync, setOutputMode));
         this->registerCall(this, POTHOS_FCN_TUPLE(FrameSync, getOutputMode));
         this->registerCall(this, POTHOS_FCN_TUPLE(FrameSync, setPreamble));
         this->registerCall(this, POTHOS_FCN_TUPLE(FrameSync, getPreamble));
         this->registerCall(this, POTHOS_FCN_TUPLE(FrameSync, setHeaderId));
         this->registerCall(this, POTHOS_FCN_TUPLE(FrameSync, getHeaderId));
+        this->registerCall(this, POTHOS_FCN_TUPLE(FrameSync, setHeaderFormat));
+        this->registerCall(this, POTHOS_FCN_TUPLE(FrameSync, getHeaderFormat));
         this->registerCall(this, POTHOS_FCN_TUPLE(FrameSync, setSymbolWidth));
         this->registerCall(this, POTHOS_FCN_TUPLE(FrameSync, getSymbolWidth));
         this->registerCall(this, POTHOS_FCN_TUPLE(FrameSync, setDataWidth));
@@ -177,11 +319,20 @@ public:
         this->registerCall(this, POTHOS_FCN_TUPLE(FrameSync, getFrameEndId));
         this->registerCall(this, POTHOS_FCN_TUPLE(FrameSync, setPhaseOffsetID));
         this->registerCall(this, POTHOS_FCN_TUPLE(FrameSync, getPhaseOffsetID));
+        this->registerCall(this, POTHOS_FCN_TUPLE(FrameSync, setSequenceID));
+        this->registerCall(this, POTHOS_FCN_TUPLE(FrameSync, getSequenceID));
+        this->registerCall(this, POTHOS_FCN_TUPLE(FrameSync, setScaleID));
+        this->registerCall(this, POTHOS_FCN_TUPLE(FrameSync, getScaleID));
         this->registerCall(this, POTHOS_FCN_TUPLE(FrameSync, setInputThreshold));
         this->registerCall(this, POTHOS_FCN_TUPLE(FrameSync, getInputThreshold));
+        this->registerCall(this, POTHOS_FCN_TUPLE(FrameSync, setCoarseSearch));
+        this->registerCall(this, POTHOS_FCN_TUPLE(FrameSync, getCoarseSearch));
+        this->registerCall(this, POTHOS_FCN_TUPLE(FrameSync, setSearchThreads));
+        this->registerCall(this, POTHOS_FCN_TUPLE(FrameSync, getSearchThreads));
         this->registerCall(this, POTHOS_FCN_TUPLE(FrameSync, setVerboseMode));
 
         this->setHeaderId(0x55); //initial update
+        this->setHeaderFormat("STANDARD"); //initial update
         this->setOutputMode("RAW"); //initial update
         this->setSymbolWidth(20); //initial update
         this->setDataWidth(4); //initial update
@@ -189,6 +340,8 @@ public:
         this->setFrameStartId("frameStart"); //initial update
         this->setFrameEndId(""); //initial update
         this->setPhaseOffsetID(""); //initial update
+        this->setSequenceID(""); //initial update
+        this->setScaleID(""); //initial update
         this->setInputThreshold(0.01); //initial update
     }
 
@@ -233,6 +386,20 @@ public:
         return _headerId;
     }
 
+    void setHeaderFormat(const std::string &format)
+    {
+        if (format == "STANDARD") _extendedHeader = false;
+        else if (format == "EXTENDED") _extendedHeader = true;
+        else throw Pothos::InvalidArgumentException("FrameSync::setHeaderFormat()", "unknown format: " + format);
+        _numHeaderBits = _extendedHeader?NUM_EXT_HEADER_BITS:NUM_HEADER_BITS;
+        this->updateSettings();
+    }
+
+    std::string getHeaderFormat(void) const
+    {
+        return _extendedHeader?"EXTENDED":"STANDARD";
+    }
+
     void setSymbolWidth(const size_t width)
     {
         if (width == 0) throw Pothos::InvalidArgumentException("FrameSync::setSymbolWidth()", "symbol width cannot be 0");
@@ -287,6 +454,26 @@ public:
         return _phaseOffsetId;
     }
 
+    void setSequenceID(std::string id)
+    {
+        _sequenceId = id;
+    }
+
+    std::string getSequenceID(void) const
+    {
+        return _sequenceId;
+    }
+
+    void setScaleID(std::string id)
+    {
+        _scaleId = id;
+    }
+
+    std::string getScaleID(void) const
+    {
+        return _scaleId;
+    }
+
     void setInputThreshold(const RealType threshold)
     {
         if (threshold < 0) throw Pothos::InvalidArgumentException("FrameSync::setInputThreshold()", "threshold should be non-negative");
@@ -298,6 +485,30 @@ public:
         return _inputThreshold;
     }
 
+    void setCoarseSearch(const bool enb)
+    {
+        _coarseSearch = enb;
+    }
+
+    bool getCoarseSearch(void) const
+    {
+        return _coarseSearch;
+    }
+
+    void setSearchThreads(const size_t numThreads)
+    {
+        if (numThreads == 0) throw Pothos::InvalidArgumentException("FrameSync::setSearchThreads()", "must have at least 1 thread");
+        _searchThreads = numThreads;
+        if (not this->isActive()) return;
+        this->stopSearchWorkers();
+        this->startSearchWorkers();
+    }
+
+    size_t getSearchThreads(void) const
+    {
+        return _searchThreads;
+    }
+
     void setVerboseMode(const bool enb)
     {
         _verbose = enb;
@@ -324,22 +535,58 @@ public:
     {
         _maxCorrPeak = 0;
         _countSinceMax = 0;
+        _searchResume = 0;
         _phase = 0;
         _phaseInc = 0;
         _remainingPayload = 0;
+        this->startSearchWorkers();
+    }
+
+    void deactivate(void)
+    {
+        this->stopSearchWorkers();
     }
 
 private:
 
-    void processEnvelope(const Type *in, RealType &scale);
-    void processFreqSync(const Type *in, RealType &deltaFc);
-    void processSyncWord(const Type *in, const RealType &deltaFc, const RealType &scale, RealType &phaseOff, size_t &corrPeak);
+    //values discovered by the search at a single offset
+    struct SearchResult
+    {
+        RealType scale;
+        RealType deltaFc;
+        RealType phaseOff;
+        size_t corrPeak;
+    };
+
+    void startSearchWorkers(void);
+    void stopSearchWorkers(void);
+    void searchWorker(void);
+    size_t searchParallel(const Type *in, const size_t begin, const size_t end);
+    void searchSegment(const Type *in, const size_t begin, const size_t end, std::vector<Type> &rotator);
+    void searchOffset(const Type *in, const size_t offset, const size_t corrThresh, std::vector<Type> &rotator, SearchResult &result) const;
+    void searchCoarse(const Type *in, const size_t numOffsets);
+
+    void updateSearchSums(const Type *in, const size_t numElems);
+    bool checkCorrBound(const size_t offset, const RealType &scale, const size_t corrThresh) const;
+    void processEnvelope(const Type *in, const size_t offset, RealType &scale) const;
+    void processFreqSync(const size_t offset, RealType &deltaFc) const;
+    void processSyncWord(const Type *in, const RealType &deltaFc, const RealType &scale, std::vector<Type> &rotator, RealType &phaseOff, size_t &corrPeak) const;
+    void processCoarseSyncWord(const size_t offset, const RealType &deltaFc, const RealType &scale, std::vector<Type> &rotator, size_t &corrPeak) const;
     void processHeaderBits(const Type *in, const RealType &deltaFc, const RealType &scale, const RealType &phaseOff, size_t &firstBit, FrameHeaderFields &headerFields);
+    void fillRotator(std::vector<Type> &rotator, const size_t num, const RealType &phaseInc) const;
+    void updatePayloadRotator(void);
+    void correctPayload(const Type *in, const size_t stride, Type *out, const size_t num);
+
+    //apply the amplitude and phase correction to an input sample
+    Type correctSample(const Type &in, const ComplexType &correction) const
+    {
+        return floatToQ<Type>(toComplex<RealType>(in)*correction, PAYLOAD_Q_BITS);
+    }
 
     void updateSettings(void)
     {
         _syncWordWidth = _symbolWidth*_dataWidth*_preamble.size();
-        _frameWidth = _syncWordWidth+(NUM_HEADER_BITS*_dataWidth);
+        _frameWidth = _syncWordWidth+(_numHeaderBits*_dataWidth);
         _corrMagThresh = size_t(_syncWordWidth*CORR_MAG_PERCENT);
         _corrDurThresh = size_t(_syncWordWidth*CORR_DUR_PERCENT);
     }
@@ -355,8 +602,12 @@ private:
     std::string _frameStartId;
     std::string _frameEndId;
     std::string _phaseOffsetId;
+    std::string _sequenceId;
+    std::string _scaleId;
     std::vector<Type> _preamble;
     unsigned char _headerId; //unique id to check frame
+    bool _extendedHeader;
+    size_t _numHeaderBits;
     size_t _symbolWidth; //width of a preamble symbol
     size_t _dataWidth; //width of a data dymbol
     size_t _syncWordWidth; //preamble sync portion width
@@ -364,11 +615,14 @@ private:
     size_t _corrMagThresh; //minimum required correlation magnitude threshold
     size_t _corrDurThresh; //minimum required correlation duration threshold
     RealType _inputThreshold; //minimum required input activation threshold
+    bool _coarseSearch; //search at the data rate before the full search
+    size_t _searchThreads; //number of threads used in the search
     bool _verbose;
 
     //values at last max correlation peak
     size_t _maxCorrPeak;
     size_t _countSinceMax;
+    size_t _searchResume; //offsets at the input start already counted since the peak
     RealType _deltaFcMax;
     RealType _phaseOffMax;
     RealType _scaleAtMax;
@@ -379,6 +633,26 @@ private:
     //calculated output offset corrections
     RealType _phase;
     RealType _phaseInc;
+    std::vector<ComplexType> _payloadRotator; //phase steps across one payload block
+
+    //running sums over the search window
+    std::vector<AccRealType> _envSums; //prefix sums of input magnitude
+    std::vector<AccType> _lagSums; //prefix sums of the frequency lag products
+    std::vector<AccType> _sampleSums; //prefix sums of the input for the coarse search
+    std::vector<bool> _searchCandidates; //offsets selected by the coarse search
+    std::vector<Type> _symbolRotator; //frequency correction across one preamble symbol
+
+    //parallel search state, segments are handed out to the workers
+    std::vector<std::thread> _workers;
+    std::mutex _searchMutex;
+    std::condition_variable _searchCond;
+    std::condition_variable _searchDoneCond;
+    std::vector<std::pair<size_t, size_t>> _searchSegments;
+    std::vector<SearchResult> _searchResults;
+    const Type *_searchIn;
+    size_t _nextSegment;
+    size_t _segmentsDone;
+    bool _workersExit;
 };
 
 /***********************************************************************
@@ -391,236 +665,534 @@ void FrameSync<Type>::work(void)
     auto outPort = this->output(0);
     const Type *in = inPort->buffer();
     Type *out = outPort->buffer();
+    const size_t inElems = inPort->elements();
+    const size_t outElems = outPort->elements();
+
+    //input and output positions as frames are processed,
+    //forward payloads and search for frames until one runs out
+    size_t consumed = 0;
+    size_t produced = 0;
+
+    //output elements that were forwarded from the input buffer,
+    //which count towards the label index but are not produced
+    size_t forwarded = 0;
 
-    /***************************************************************
-     * Produce payload with no compensation
-     **************************************************************/
-    if (_remainingPayload != 0 and _outputModeRaw)
+    //the search sums and results cover the entire input buffer,
+    //so they are calculated once and shared by every frame search
+    bool searchReady = false;
+    size_t searchedEnd = 0;
+
+    while (true)
     {
-        const auto N = std::min(_remainingPayload, this->workInfo().minElements);
+        /***************************************************************
+         * Forward payload with no compensation (zero copy)
+         **************************************************************/
+        if (_remainingPayload != 0 and _outputModeRaw and not _scaleId.empty())
+        {
+            const auto N = std::min(_remainingPayload, inElems-consumed);
+
+            Pothos::BufferChunk payloadBuff = inPort->buffer();
+            payloadBuff.address += consumed*sizeof(Type);
+            payloadBuff.length = N*sizeof(Type);
+            if (N != 0) outPort->postBuffer(std::move(payloadBuff));
+
+            _remainingPayload -= N;
+            consumed += N;
+            produced += N;
+            forwarded += N;
+            if (_remainingPayload != 0) break;
+            continue;
+        }
 
-        for (size_t i = 0; i < N; i++)
+        /***************************************************************
+         * Produce payload with no compensation
+         **************************************************************/
+        else if (_remainingPayload != 0 and _outputModeRaw)
         {
-            out[i] = in[i]*_scaleAtMax;
+            const auto N = std::min(_remainingPayload, std::min(inElems-consumed, outElems-produced));
+
+            for (size_t i = 0; i < N; i++)
+            {
+                out[produced+i] = this->correctSample(in[consumed+i], _scaleAtMax);
+            }
+
+            _remainingPayload -= N;
+            consumed += N;
+            produced += N;
+            if (_remainingPayload != 0) break;
+            continue;
         }
 
-        _remainingPayload -= N;
-        inPort->consume(N);
-        outPort->produce(N);
-        return;
-    }
+        /***************************************************************
+         * Produce payload with phase compensation
+         **************************************************************/
+        else if (_remainingPayload != 0 and _outputModePhase)
+        {
+            const auto N = std::min(_remainingPayload, std::min(inElems-consumed, outElems-produced));
 
-    /***************************************************************
-     * Produce payload with phase compensation
-     **************************************************************/
-    else if (_remainingPayload != 0 and _outputModePhase)
-    {
-        const auto N = std::min(_remainingPayload, this->workInfo().minElements);
+            this->correctPayload(in+consumed, 1, out+produced, N);
+
+            _remainingPayload -= N;
+            consumed += N;
+            produced += N;
+            if (_remainingPayload != 0) break;
+            continue;
+        }
 
-        for (size_t i = 0; i < N; i++)
+        /***************************************************************
+         * Produce payload with timing compensation
+         **************************************************************/
+        else if (_remainingPayload != 0 and _outputModeTiming)
         {
-            out[i] = in[i]*std::polar<RealType>(_scaleAtMax, _phase);
-            _phase += _phaseInc;
+            auto N = std::min(_remainingPayload, inElems-consumed);
+            N = std::min(N/_dataWidth, outElems-produced);
+            if (N == 0 and inElems-consumed < _dataWidth) inPort->setReserve(_dataWidth);
+
+            this->correctPayload(in+consumed, _dataWidth, out+produced, N);
+
+            _remainingPayload -= N*_dataWidth;
+            consumed += N*_dataWidth;
+            produced += N;
+            //if (_remainingPayload == 0) std::cout << "payload forwarded\n";
+            if (_remainingPayload != 0) break;
+            continue;
         }
 
-        _remainingPayload -= N;
-        inPort->consume(N);
-        outPort->produce(N);
-        return;
-    }
+        /***************************************************************
+         * Correlation search for a new frame
+         **************************************************************/
+        const size_t requireMin = _frameWidth;
+        if (inElems-consumed < requireMin)
+        {
+            inPort->setReserve(requireMin);
+            break;
+        }
+        const auto N = inElems-requireMin+1;
 
-    /***************************************************************
-     * Produce payload with timing compensation
-     **************************************************************/
-    else if (_remainingPayload != 0 and _outputModeTiming)
-    {
-        auto N = std::min(_remainingPayload, inPort->elements());
-        N = std::min(N/_dataWidth, outPort->elements());
-        if (N == 0) inPort->setReserve(_dataWidth);
+        if (not searchReady)
+        {
+            //envelope and frequency sums are shared by all search offsets
+            this->updateSearchSums(in, inElems);
+
+            //the coarse search narrows down the offsets for the full search
+            if (_coarseSearch) this->searchCoarse(in, N);
+            searchReady = true;
+        }
 
-        for (size_t i = 0; i < N; i++)
+        //when worker threads are available, offsets are searched ahead in parallel,
+        //otherwise each offset is searched in order in the loop below;
+        //results searched ahead of a previous frame in this buffer remain valid
+        const size_t searchStart = consumed + _searchResume;
+        _searchResume = 0;
+        searchedEnd = std::max(searchedEnd, searchStart);
+
+        bool frameFound = false;
+        for (size_t i = searchStart; i < N; i++)
         {
-            const auto sym = in[i*_dataWidth];
-            out[i] = sym*std::polar<RealType>(_scaleAtMax, _phase);
-            _phase += _phaseInc*_dataWidth;
+            if (i == searchedEnd) searchedEnd = this->searchParallel(in, i, N);
+
+            //process the potential frame to discover these values
+            SearchResult result;
+            if (i < searchedEnd) result = _searchResults[i];
+            else this->searchOffset(in, i, std::max(_maxCorrPeak, _corrMagThresh), _symbolRotator, result);
+            const size_t corrPeak = result.corrPeak;
+
+            //if this correlation value is larger, record the state
+            if (corrPeak > _maxCorrPeak and corrPeak > _corrMagThresh)
+            {
+                _maxCorrPeak = corrPeak;
+                _countSinceMax = 0;
+                _deltaFcMax = result.deltaFc;
+                _phaseOffMax = result.phaseOff;
+                _scaleAtMax = result.scale;
+                //std::cout << " new _maxCorrPeak = " << _maxCorrPeak << std::endl;
+            }
+            _countSinceMax++;
+
+            //check if the peak is above the threshold and we have not found
+            //a greater correlation peak within the specified duration threshold
+            if (_maxCorrPeak < _corrMagThresh) continue;
+            if (_countSinceMax < _corrDurThresh) continue;
+
+            //print summary
+            if (_verbose)
+            {
+                std::cout << "PEAK FOUND \n";
+                std::cout << " countSinceMax = " << _countSinceMax << std::endl;
+                std::cout << " maxCorrPeak = " << _maxCorrPeak << std::endl;
+                std::cout << " deltaFcMax = " << _deltaFcMax << std::endl;
+                std::cout << " phaseOffMax = " << _phaseOffMax << std::endl;
+                std::cout << " scaleAtMax = " << _scaleAtMax << std::endl;
+            }
+
+            _maxCorrPeak = 0; //reset for next time
+
+            //now that the frame was found, process the length field
+            //and determine sample offset (used in timing recovery mode)
+            size_t firstBit = 0;
+            size_t frameOffset = i-_countSinceMax;
+            FrameHeaderFields headerFields;
+            this->processHeaderBits(in+frameOffset, _deltaFcMax, _scaleAtMax, _phaseOffMax, firstBit, headerFields);
+
+            //print summary
+            if (_verbose)
+            {
+                std::cout << "HEADER DECODE \n";
+                std::cout << " length = " << headerFields.length << std::endl;
+                std::cout << " src id = 0x" << std::hex << int(headerFields.id) << std::dec << std::endl;
+                if (_extendedHeader)
+                {
+                    std::cout << " version = " << int(headerFields.version) << std::endl;
+                    std::cout << " seq = " << headerFields.seq << std::endl;
+                    std::cout << " crc = 0x" << std::hex << headerFields.crc << std::dec << std::endl;
+                }
+                else std::cout << " chksum = 0x" << std::hex << int(headerFields.chksum) << std::dec << std::endl;
+            }
+
+            if (headerFields.error) continue; //error correction not possible
+            if (_extendedHeader)
+            {
+                if (headerFields.version != EXT_HEADER_VERSION) continue; //unknown version
+                if (headerFields.crc != headerFields.doCrc()) continue; //crc failed
+            }
+            else if (headerFields.chksum != headerFields.doChecksum()) continue; //checksum failed
+            if (headerFields.id != _headerId) continue; //reject unknown id
+            if (headerFields.length == 0) continue; //length not provided
+            const size_t length = headerFields.length;
+
+            //Label width is specified based on the output mode.
+            //Width may be divided down by an upstream time recovery block.
+            //The length and label width are used in conjunction to specify
+            //the number of elements between start and end labels.
+            const size_t labelWidth = _outputModeTiming?1:_dataWidth;
+
+            //initialize carrier recovery compensation for use in the
+            //remaining header and payload sections of the work routine
+            size_t payloadOffset = frameOffset + firstBit + (_numHeaderBits*_dataWidth) + labelWidth/2;
+            size_t labelStart = produced;
+            size_t labelEnd = produced + (length-1)*labelWidth;
+            _remainingPayload = headerFields.length*_dataWidth;
+            _phaseInc = _deltaFcMax;
+            _phase = _phaseOffMax + _phaseInc*_frameWidth;
+            this->updatePayloadRotator();
+            if (_verbose)
+            {
+                std::cout << "FRAME VALID \n";
+                std::cout << " firstBit = " << firstBit << std::endl;
+                std::cout << " sampOffset = " << (int(firstBit)-int(_syncWordWidth)) << std::endl;
+                std::cout << " frameOffset = " << frameOffset << std::endl;
+                std::cout << " payloadOffset = " << payloadOffset << std::endl;
+            }
+
+            //adjust for the debug mode
+            if (_outputModeDebug)
+            {
+                const size_t backup = std::min(payloadOffset-consumed, _frameWidth);
+                labelStart += backup;
+                labelEnd += backup;
+                _phase -= _phaseInc*backup;
+                _remainingPayload += backup;
+                payloadOffset -= backup;
+            }
+
+            //produce a phase offset label at the first payload index
+            if (not _phaseOffsetId.empty()) outPort->postLabel(
+                _phaseOffsetId, _phase, labelStart, labelWidth);
+
+            //produce a start of frame label at the first payload index
+            if (not _frameStartId.empty()) outPort->postLabel(
+                _frameStartId, length, labelStart, labelWidth);
+
+            //produce an end of frame label at the last payload index
+            if (not _frameEndId.empty()) outPort->postLabel(
+                _frameEndId, length, labelEnd, labelWidth);
+
+            //produce a sequence number label at the first payload index
+            if (not _sequenceId.empty() and _extendedHeader) outPort->postLabel(
+                _sequenceId, size_t(headerFields.seq), labelStart, labelWidth);
+
+            //produce an amplitude scale label at the first payload index
+            if (not _scaleId.empty() and _outputModeRaw) outPort->postLabel(
+                _scaleId, _scaleAtMax, labelStart, labelWidth);
+
+            inPort->setReserve(0);
+            consumed = payloadOffset;
+            frameFound = true;
+            break;
         }
 
-        const size_t consumed = N*_dataWidth;
-        _remainingPayload -= consumed;
-        inPort->consume(consumed);
-        outPort->produce(N);
-        //if (_remainingPayload == 0) std::cout << "payload forwarded\n";
-        return;
+        //no frame in the remaining offsets, wait for more input;
+        //keep the input from a pending peak onward and search it again,
+        //so that the frame is not consumed before its header is decoded.
+        //When the frame already starts at the first kept offset,
+        //keep the peak and resume the search after the offsets counted so far.
+        if (not frameFound)
+        {
+            if (_maxCorrPeak != 0 and _countSinceMax < N-consumed)
+            {
+                const size_t frameOffset = N-_countSinceMax-1;
+                if (frameOffset > consumed)
+                {
+                    consumed = frameOffset;
+                    _maxCorrPeak = 0;
+                }
+                else _searchResume = N-consumed;
+            }
+            else consumed = N;
+            break;
+        }
     }
 
-    /***************************************************************
-     * Correlation search for a new frame
-     **************************************************************/
-    const size_t requireMin = _frameWidth;
-    if (inPort->elements() < requireMin)
+    inPort->consume(consumed);
+    outPort->produce(produced-forwarded);
+}
+
+/***********************************************************************
+ * Search worker thread pool
+ **********************************************************************/
+template <typename Type>
+void FrameSync<Type>::startSearchWorkers(void)
+{
+    //the work thread searches one of the segments itself
+    _workersExit = false;
+    for (size_t i = 1; i < _searchThreads; i++)
     {
-        inPort->setReserve(requireMin);
-        return;
+        _workers.emplace_back(&FrameSync<Type>::searchWorker, this);
     }
-    const auto N = inPort->elements()-requireMin+1;
+}
 
-    for (size_t i = 0; i < N; i++)
+template <typename Type>
+void FrameSync<Type>::stopSearchWorkers(void)
+{
     {
-        //process the potential frame to discover these values
-        RealType scale = 0;
-        RealType deltaFc = 0;
-        RealType phaseOff = 0;
-        size_t corrPeak = 0;
+        std::lock_guard<std::mutex> lock(_searchMutex);
+        _workersExit = true;
+    }
+    _searchCond.notify_all();
+    for (auto &worker : _workers) worker.join();
+    _workers.clear();
+}
 
-        //calculate the scaling value, and check for consistent envelope
-        this->processEnvelope(in+i, scale);
+template <typename Type>
+void FrameSync<Type>::searchWorker(void)
+{
+    std::vector<Type> rotator;
+    std::unique_lock<std::mutex> lock(_searchMutex);
+    while (true)
+    {
+        _searchCond.wait(lock, [this]{return _workersExit or _nextSegment < _searchSegments.size();});
+        if (_workersExit) return;
+        const auto segment = _searchSegments[_nextSegment++];
+        const auto in = _searchIn;
+        lock.unlock();
+        this->searchSegment(in, segment.first, segment.second, rotator);
+        lock.lock();
+        if (++_segmentsDone == _searchSegments.size()) _searchDoneCond.notify_one();
+    }
+}
 
-        //calculate the frequency offset as if this was the frame start
-        if (scale != 0) this->processFreqSync(in+i, deltaFc);
+/***********************************************************************
+ * Search the offsets in parallel across the worker threads
+ **********************************************************************/
+template <typename Type>
+size_t FrameSync<Type>::searchParallel(const Type *in, const size_t begin, const size_t end)
+{
+    //each segment should search at least one frame width worth of offsets
+    const size_t numSegments = std::min(_workers.size()+1, (end-begin)/_frameWidth);
+    if (numSegments < 2) return begin;
+
+    //limit the segments to a few frame widths so that
+    //little work is discarded when a frame is found early
+    const size_t segmentSize = std::min((end-begin)/numSegments, 4*_frameWidth);
+    const size_t searchEnd = begin + numSegments*segmentSize;
+    _searchResults.resize(end);
+
+    //the input window of each segment extends a frame width past its last offset,
+    //which overlaps the input of the next segment (the search sums are shared)
+    std::unique_lock<std::mutex> lock(_searchMutex);
+    _searchIn = in;
+    _searchSegments.clear();
+    for (size_t i = 0; i < numSegments; i++)
+    {
+        _searchSegments.emplace_back(begin + i*segmentSize, begin + (i+1)*segmentSize);
+    }
+    _nextSegment = 0;
+    _segmentsDone = 0;
+    _searchCond.notify_all();
 
-        //use the frequency offset to calculate the correlation value
-        if (scale != 0) this->processSyncWord(in+i, deltaFc, scale, phaseOff, corrPeak);
+    //the work thread takes segments until none are left
+    while (_nextSegment < _searchSegments.size())
+    {
+        const auto segment = _searchSegments[_nextSegment++];
+        lock.unlock();
+        this->searchSegment(in, segment.first, segment.second, _symbolRotator);
+        lock.lock();
+        _segmentsDone++;
+    }
 
-        //if this correlation value is larger, record the state
-        if (corrPeak > _maxCorrPeak and corrPeak > _corrMagThresh)
-        {
-            _maxCorrPeak = corrPeak;
-            _countSinceMax = 0;
-            _deltaFcMax = deltaFc;
-            _phaseOffMax = phaseOff;
-            _scaleAtMax = scale;
-            //std::cout << " new _maxCorrPeak = " << _maxCorrPeak << std::endl;
-        }
-        _countSinceMax++;
+    //wait on the workers to finish the remaining segments
+    _searchDoneCond.wait(lock, [this]{return _segmentsDone == _searchSegments.size();});
+    _searchSegments.clear();
+    _nextSegment = 0;
+    return searchEnd;
+}
 
-        //check if the peak is above the threshold and we have not found
-        //a greater correlation peak within the specified duration threshold
-        if (_maxCorrPeak < _corrMagThresh) continue;
-        if (_countSinceMax < _corrDurThresh) continue;
+template <typename Type>
+void FrameSync<Type>::searchSegment(const Type *in, const size_t begin, const size_t end, std::vector<Type> &rotator)
+{
+    //the peak is not known ahead of time, so only the
+    //magnitude threshold is used to skip the correlation
+    for (size_t i = begin; i < end; i++)
+    {
+        this->searchOffset(in, i, _corrMagThresh, rotator, _searchResults[i]);
+    }
+}
 
-        //print summary
-        if (_verbose)
-        {
-            std::cout << "PEAK FOUND \n";
-            std::cout << " countSinceMax = " << _countSinceMax << std::endl;
-            std::cout << " maxCorrPeak = " << _maxCorrPeak << std::endl;
-            std::cout << " deltaFcMax = " << _deltaFcMax << std::endl;
-            std::cout << " phaseOffMax = " << _phaseOffMax << std::endl;
-            std::cout << " scaleAtMax = " << _scaleAtMax << std::endl;
-        }
+/***********************************************************************
+ * Search a single offset for the frame start
+ **********************************************************************/
+template <typename Type>
+void FrameSync<Type>::searchOffset(const Type *in, const size_t offset, const size_t corrThresh, std::vector<Type> &rotator, SearchResult &result) const
+{
+    result.scale = 0;
+    result.deltaFc = 0;
+    result.phaseOff = 0;
+    result.corrPeak = 0;
 
-        _maxCorrPeak = 0; //reset for next time
+    //skip offsets that were ruled out by the coarse search
+    if (_coarseSearch and not _searchCandidates[offset]) return;
 
-        //now that the frame was found, process the length field
-        //and determine sample offset (used in timing recovery mode)
-        size_t firstBit = 0;
-        size_t frameOffset = i-_countSinceMax;
-        FrameHeaderFields headerFields;
-        this->processHeaderBits(in+frameOffset, _deltaFcMax, _scaleAtMax, _phaseOffMax, firstBit, headerFields);
+    //calculate the scaling value, and check for consistent envelope
+    this->processEnvelope(in, offset, result.scale);
+    if (result.scale == 0) return;
 
-        //print summary
-        if (_verbose)
-        {
-            std::cout << "HEADER DECODE \n";
-            std::cout << " length = " << headerFields.length << std::endl;
-            std::cout << " src id = 0x" << std::hex << int(headerFields.id) << std::dec << std::endl;
-            std::cout << " chksum = 0x" << std::hex << int(headerFields.chksum) << std::dec << std::endl;
-        }
+    //skip offsets that cannot produce a correlation above the threshold
+    if (not this->checkCorrBound(offset, result.scale, corrThresh)) return;
 
-        if (headerFields.error) continue; //error correction not possible
-        if (headerFields.chksum != headerFields.doChecksum()) continue; //checksum failed
-        if (headerFields.id != _headerId) continue; //reject unknown id
-        if (headerFields.length == 0) continue; //length not provided
-        const size_t length = headerFields.length;
-
-        //Label width is specified based on the output mode.
-        //Width may be divided down by an upstream time recovery block.
-        //The length and label width are used in conjunction to specify
-        //the number of elements between start and end labels.
-        const size_t labelWidth = _outputModeTiming?1:_dataWidth;
-
-        //initialize carrier recovery compensation for use in the
-        //remaining header and payload sections of the work routine
-        size_t payloadOffset = frameOffset + firstBit + (NUM_HEADER_BITS*_dataWidth) + labelWidth/2;
-        size_t labelStart = 0;
-        size_t labelEnd = (length-1)*labelWidth;
-        _remainingPayload = headerFields.length*_dataWidth;
-        _phaseInc = _deltaFcMax;
-        _phase = _phaseOffMax + _phaseInc*_frameWidth;
-        if (_verbose)
-        {
-            std::cout << "FRAME VALID \n";
-            std::cout << " firstBit = " << firstBit << std::endl;
-            std::cout << " sampOffset = " << (int(firstBit)-int(_syncWordWidth)) << std::endl;
-            std::cout << " frameOffset = " << frameOffset << std::endl;
-            std::cout << " payloadOffset = " << payloadOffset << std::endl;
-        }
+    //calculate the frequency offset as if this was the frame start
+    this->processFreqSync(offset, result.deltaFc);
 
-        //adjust for the debug mode
-        if (_outputModeDebug)
-        {
-            const size_t backup = std::min(payloadOffset, _frameWidth);
-            labelStart += backup;
-            labelEnd += backup;
-            _phase -= _phaseInc*backup;
-            _remainingPayload += backup;
-            payloadOffset -= backup;
-        }
+    //use the frequency offset to calculate the correlation value
+    this->processSyncWord(in+offset, result.deltaFc, result.scale, rotator, result.phaseOff, result.corrPeak);
+}
 
-        //produce a phase offset label at the first payload index
-        if (not _phaseOffsetId.empty()) outPort->postLabel(
-            _phaseOffsetId, _phase, labelStart, labelWidth);
+/***********************************************************************
+ * Coarse search at the data rate to select candidate offsets
+ **********************************************************************/
+template <typename Type>
+void FrameSync<Type>::searchCoarse(const Type *in, const size_t numOffsets)
+{
+    //the coarse search steps by the data width, so the candidates
+    //are all offsets within a step of a correlation above threshold
+    const size_t step = _dataWidth;
+    _searchCandidates.assign(numOffsets, false);
+    for (size_t i = 0; i < numOffsets; i += step)
+    {
+        RealType scale = 0;
+        this->processEnvelope(in, i, scale);
+        if (scale == 0) continue;
+        if (not this->checkCorrBound(i, scale, _corrMagThresh)) continue;
 
-        //produce a start of frame label at the first payload index
-        if (not _frameStartId.empty()) outPort->postLabel(
-            _frameStartId, length, labelStart, labelWidth);
+        RealType deltaFc = 0;
+        size_t corrPeak = 0;
+        this->processFreqSync(i, deltaFc);
+        this->processCoarseSyncWord(i, deltaFc, scale, _symbolRotator, corrPeak);
+        if (corrPeak <= _corrMagThresh) continue;
+
+        const size_t begin = (i < step)?0:(i-step+1);
+        const size_t end = std::min(numOffsets, i+step);
+        std::fill(_searchCandidates.begin()+begin, _searchCandidates.begin()+end, true);
+    }
+}
+
+/***********************************************************************
+ * Update the running sums used by the correlation search
+ **********************************************************************/
+template <typename Type>
+void FrameSync<Type>::updateSearchSums(const Type *in, const size_t numElems)
+{
+    //prefix sums of the input magnitude:
+    //any envelope window is the difference of two sums
+    _envSums.resize(numElems+1);
+    _envSums[0] = 0;
+    for (size_t n = 0; n < numElems; n++)
+    {
+        _envSums[n+1] = _envSums[n] + getAbs<AccRealType>(in[n]);
+    }
+
+    //prefix sums of the lag products used in the frequency estimate:
+    //the lag is half of a preamble symbol (see processFreqSync)
+    const size_t delta = (_symbolWidth*_dataWidth)/2;
+    const size_t numLags = (numElems > delta)?(numElems-delta):0;
+    _lagSums.resize(numLags+1);
+    _lagSums[0] = 0;
+    for (size_t n = 0; n < numLags; n++)
+    {
+        _lagSums[n+1] = _lagSums[n] + AccType(in[n]) * std::conj(AccType(in[n+delta]));
+    }
 
-        //produce an end of frame label at the last payload index
-        if (not _frameEndId.empty()) outPort->postLabel(
-            _frameEndId, length, labelEnd, labelWidth);
+    //prefix sums of the input: the coarse search uses
+    //the difference of two sums as a boxcar over a data width
+    if (not _coarseSearch) return;
+    _sampleSums.resize(numElems+1);
+    _sampleSums[0] = 0;
+    for (size_t n = 0; n < numElems; n++)
+    {
+        _sampleSums[n+1] = _sampleSums[n] + AccType(in[n]);
+    }
+}
 
-        inPort->setReserve(0);
-        inPort->consume(payloadOffset);
-        return;
+/***********************************************************************
+ * Check if the correlation could exceed the threshold at this offset
+ **********************************************************************/
+template <typename Type>
+bool FrameSync<Type>::checkCorrBound(const size_t offset, const RealType &scale, const size_t corrThresh) const
+{
+    //the correlation magnitude cannot exceed the sum of the
+    //scaled input magnitudes weighted by each preamble symbol
+    const size_t width = _symbolWidth*_dataWidth;
+    double bound = 0;
+    for (size_t i = 0; i < _preamble.size(); i++)
+    {
+        const size_t begin = offset + i*width;
+        bound += std::abs(toComplex<double>(_preamble[i]))*(_envSums[begin+width]-_envSums[begin]);
     }
-    inPort->consume(N);
+    bound *= scale;
+
+    //a new peak must be at least corrThresh+1,
+    //leave some margin for rounding in the correlation sum
+    return bound*1.001 >= double(corrThresh+1);
 }
 
 /***********************************************************************
  * Process the envelope of the frame preamble
  **********************************************************************/
 template <typename Type>
-void FrameSync<Type>::processEnvelope(const Type *in, RealType &scale)
+void FrameSync<Type>::processEnvelope(const Type *in, const size_t offset, RealType &scale) const
 {
     scale = 0;
 
     //spot check the amplitude near the sync word edges
-    if (std::abs(in[_dataWidth]) < _inputThreshold) return;
-    if (std::abs(in[_syncWordWidth-_dataWidth]) < _inputThreshold) return;
+    if (getAbs<AccRealType>(in[offset+_dataWidth]) < _inputThreshold) return;
+    if (getAbs<AccRealType>(in[offset+_syncWordWidth-_dataWidth]) < _inputThreshold) return;
 
     //get a rough average of amplitude at the beginning
     RealType sum0 = 0;
     const size_t begin0 = _dataWidth;
     const size_t end0 = (_symbolWidth*_dataWidth/2);
-    for (size_t i = begin0; i < end0; i++)
-    {
-        sum0 += std::abs(in[i]);
-    }
+    if (end0 > begin0) sum0 = RealType(_envSums[offset+end0]-_envSums[offset+begin0]);
     sum0 /= (end0-begin0);
     if (sum0 < _inputThreshold) return;
-    sum0 /= std::abs(_preamble.front());
+    sum0 /= std::abs(toComplex<RealType>(_preamble.front()));
 
     //get a rough average of amplitude at the end
     RealType sum1 = 0;
     const size_t begin1 = _syncWordWidth-(_symbolWidth*_dataWidth/2);
     const size_t end1 = _syncWordWidth-_dataWidth;
-    for (size_t i = begin1; i < end1; i++)
-    {
-        sum1 += std::abs(in[i]);
-    }
+    if (end1 > begin1) sum1 = RealType(_envSums[offset+end1]-_envSums[offset+begin1]);
     sum1 /= (end1-begin1);
     if (sum1 < _inputThreshold) return;
-    sum1 /= std::abs(_preamble.back());
+    sum1 /= std::abs(toComplex<RealType>(_preamble.back()));
 
     //check for consistent amplitude across the frame
     const auto ratio = sum0/sum1;
@@ -634,13 +1206,13 @@ void FrameSync<Type>::processEnvelope(const Type *in, RealType &scale)
  * Process the frame sync to find the freq offset
  **********************************************************************/
 template <typename Type>
-void FrameSync<Type>::processFreqSync(const Type *in, RealType &deltaFc)
+void FrameSync<Type>::processFreqSync(const size_t offset, RealType &deltaFc) const
 {
     //width of a preamble symbol in samples
     const size_t width = _symbolWidth*_dataWidth;
 
     //offset into the start of the final preamble symbol
-    auto syms = in + width*(_preamble.size()-1);
+    const size_t syms = offset + width*(_preamble.size()-1);
 
     //difference between any two compare samples
     const size_t delta = width/2;
@@ -652,35 +1224,87 @@ void FrameSync<Type>::processFreqSync(const Type *in, RealType &deltaFc)
 
     //calculate the frequency offset across multiple
     //pairs of samples that are within the same symbol
-    Type K = 0;
-    for (size_t i = begin; i < end; i++)
+    AccType K = 0;
+    if (width > delta + 2*padding) K = _lagSums[syms+end] - _lagSums[syms+begin];
+    deltaFc = RealType(getPhase(K)/delta);
+}
+
+/***********************************************************************
+ * Fill the rotator with unit phasors (Q format for fixed point)
+ **********************************************************************/
+template <typename Type>
+void FrameSync<Type>::fillRotator(std::vector<Type> &rotator, const size_t num, const RealType &phaseInc) const
+{
+    rotator.resize(num);
+    const auto step = std::polar<RealType>(1, phaseInc);
+    ComplexType phasor(1);
+    for (size_t j = 0; j < num; j++)
+    {
+        rotator[j] = floatToQ<Type>(phasor, ROTATOR_Q_BITS);
+        phasor *= step;
+    }
+}
+
+/***********************************************************************
+ * Payload phase correction with a block rotator
+ **********************************************************************/
+template <typename Type>
+void FrameSync<Type>::updatePayloadRotator(void)
+{
+    //the phase steps across a block only depend on the frequency offset,
+    //in timing mode, the payload is decimated down to the data width
+    const auto phaseInc = _outputModeTiming?(_phaseInc*_dataWidth):_phaseInc;
+    _payloadRotator.resize(PAYLOAD_BLOCK_SIZE);
+    for (size_t j = 0; j < PAYLOAD_BLOCK_SIZE; j++)
     {
-        K += syms[i] * std::conj(syms[i+delta]);
+        _payloadRotator[j] = std::polar<RealType>(1, phaseInc*j);
+    }
+}
+
+template <typename Type>
+void FrameSync<Type>::correctPayload(const Type *in, const size_t stride, Type *out, const size_t num)
+{
+    //the phase is evaluated once per block, the inner loop is a table of
+    //complex multiplies, and no rounding error accumulates across blocks
+    const auto phaseInc = _phaseInc*stride;
+    for (size_t i = 0; i < num; i += PAYLOAD_BLOCK_SIZE)
+    {
+        const size_t n = std::min(PAYLOAD_BLOCK_SIZE, num-i);
+        const auto phasor = std::polar<RealType>(_scaleAtMax, _phase);
+        for (size_t j = 0; j < n; j++)
+        {
+            out[i+j] = this->correctSample(in[(i+j)*stride], phasor*_payloadRotator[j]);
+        }
+        _phase += phaseInc*n;
     }
-    deltaFc = std::arg(K)/delta;
 }
 
 /***********************************************************************
  * Process the sync word to find the max correlation
  **********************************************************************/
 template <typename Type>
-void FrameSync<Type>::processSyncWord(const Type *in, const RealType &deltaFc, const RealType &scale, RealType &phaseOff, size_t &corrPeak)
+void FrameSync<Type>::processSyncWord(const Type *in, const RealType &deltaFc, const RealType &scale, std::vector<Type> &rotator, RealType &phaseOff, size_t &corrPeak) const
 {
+    //the frequency correction within a preamble symbol is the same
+    //for every symbol, so it only needs to be calculated once
+    const auto width = _symbolWidth*_dataWidth;
+    this->fillRotator(rotator, width, deltaFc);
+
     //using scale and frequency offset, calculate correlation
-    Type L = 0;
-    RealType freqCorr = 0;
+    ComplexType L = 0;
     auto frameSyms = in;
-    const auto width = _symbolWidth*_dataWidth;
     for (size_t i = 0; i < _preamble.size(); i++)
     {
-        const auto sym = std::conj(_preamble[i]);
+        CorrType symCorr = 0;
         for (size_t j = 0; j < width; j++)
         {
-            auto frameSym = *frameSyms++;
-            L += sym*frameSym*std::polar<RealType>(scale, freqCorr);
-            freqCorr += deltaFc;
+            symCorr += CorrType(*frameSyms++)*CorrType(rotator[j]);
         }
+        const auto freqCorr = deltaFc*RealType(i*width);
+        const auto symCorrF = toComplex<RealType>(fromQ<CorrType>(symCorr, ROTATOR_Q_BITS));
+        L += std::conj(toComplex<RealType>(_preamble[i]))*symCorrF*std::polar<RealType>(1, freqCorr);
     }
+    L *= scale;
 
     //the phase offset at the first point is the angle of L
     phaseOff = -std::arg(L);
@@ -689,6 +1313,37 @@ void FrameSync<Type>::processSyncWord(const Type *in, const RealType &deltaFc, c
     corrPeak = size_t(std::abs(L));
 }
 
+/***********************************************************************
+ * Process the sync word at the data rate for the coarse search
+ **********************************************************************/
+template <typename Type>
+void FrameSync<Type>::processCoarseSyncWord(const size_t offset, const RealType &deltaFc, const RealType &scale, std::vector<Type> &rotator, size_t &corrPeak) const
+{
+    //frequency correction at the data rate across one preamble symbol
+    const auto width = _symbolWidth*_dataWidth;
+    this->fillRotator(rotator, _symbolWidth, deltaFc*_dataWidth);
+
+    //correlate the boxcar sums of each data width with the preamble
+    ComplexType L = 0;
+    for (size_t i = 0; i < _preamble.size(); i++)
+    {
+        AccType symCorr = 0;
+        size_t n = offset + i*width;
+        for (size_t j = 0; j < _symbolWidth; j++)
+        {
+            symCorr += (_sampleSums[n+_dataWidth]-_sampleSums[n])*AccType(rotator[j]);
+            n += _dataWidth;
+        }
+        const auto freqCorr = deltaFc*RealType(i*width);
+        const auto symCorrF = toComplex<RealType>(fromQ<AccType>(symCorr, ROTATOR_Q_BITS));
+        L += std::conj(toComplex<RealType>(_preamble[i]))*symCorrF*std::polar<RealType>(1, freqCorr);
+    }
+    L *= scale;
+
+    //the correlation peak is the magnitude of L
+    corrPeak = size_t(std::abs(L));
+}
+
 /***********************************************************************
  * Process the length bits to get a symbol count
  **********************************************************************/
@@ -698,16 +1353,20 @@ void FrameSync<Type>::processHeaderBits(const Type *in, const RealType &deltaFc,
     firstBit = 0;
 
     //the last preamble symbol is used to encode the phase shifts
-    const auto sym = std::conj(_preamble.back());
+    const auto sym = std::conj(toComplex<RealType>(_preamble.back()));
 
     //use the intentional phase transition at the header start
     //to determine the optimal sampling offset to decode BPSK
     //search from the middle of the last symbol to the frame end
     firstBit = _syncWordWidth + _dataWidth/2;
     RealType firstBitPeak = 0;
-    for (size_t i = _syncWordWidth-(_dataWidth*_symbolWidth/2); i < _frameWidth; i++)
+    const size_t searchStart = _syncWordWidth-(_dataWidth*_symbolWidth/2);
+    const auto sampleStep = std::polar<RealType>(1, deltaFc);
+    auto phasor = std::polar<RealType>(scale, phaseOff + deltaFc*searchStart)*sym;
+    for (size_t i = searchStart; i < _frameWidth; i++)
     {
-        auto bit = in[i]*std::polar<RealType>(scale, phaseOff + deltaFc*i)*sym;
+        const auto bit = toComplex<RealType>(in[i])*phasor;
+        phasor *= sampleStep;
         if (bit.real() > firstBitPeak)
         {
             if (firstBitPeak == 0) continue; //before peak found
@@ -722,21 +1381,23 @@ void FrameSync<Type>::processHeaderBits(const Type *in, const RealType &deltaFc,
 
     //offsets to sampling index of header bits
     auto headerSyms = in + firstBit;
-    RealType freqCorr = phaseOff + deltaFc*(firstBit);
+    const auto bitStep = std::polar<RealType>(1, deltaFc*_dataWidth);
+    phasor = std::polar<RealType>(scale, phaseOff + deltaFc*firstBit)*sym;
 
     //decode from BPSK into header field bits
     //the bit value is the phase difference with the last symbol
-    char headerBits[NUM_HEADER_BITS];
-    for (size_t i = 0; i < NUM_HEADER_BITS; i++)
+    char headerBits[NUM_EXT_HEADER_BITS];
+    for (size_t i = 0; i < _numHeaderBits; i++)
     {
-        auto bit = (*headerSyms)*std::polar<RealType>(scale, freqCorr)*sym;
+        const auto bit = toComplex<RealType>(*headerSyms)*phasor;
         headerBits[i] = (bit.real() > 0)?1:0;
-        freqCorr += deltaFc*_dataWidth;
+        phasor *= bitStep;
         headerSyms += _dataWidth;
     }
 
     //decode the bits into header fields
-    decodeHeaderWord(headerBits, headerFields);
+    if (_extendedHeader) decodeExtHeaderWord(headerBits, headerFields);
+    else decodeHeaderWord(headerBits, headerFields);
 }
 
 /***********************************************************************
@@ -749,6 +1410,7 @@ static Pothos::Block *FrameSyncFactory(const Pothos::DType &dtype)
             return new FrameSync<std::complex<type>>();
     ifTypeDeclareFactory(double);
     ifTypeDeclareFactory(float);
+    ifTypeDeclareFactory(int16_t);
     throw Pothos::InvalidArgumentException("FrameSyncFactory("+dtype.toString()+")", "unsupported type");
 }
 
@@ -0,0 +1,132 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#include "FrameHelper.hpp"
+#include <Pothos/Testing.hpp>
+#include <cstring> //strlen
+#include <vector>
+
+//the checks of the frame sync on a decoded extended header
+static bool extHeaderRejected(const FrameHeaderFields &hdr)
+{
+    if (hdr.error) return true;
+    if (hdr.version != EXT_HEADER_VERSION) return true;
+    return hdr.crc != hdr.doCrc();
+}
+
+static FrameHeaderFields extHeaderFields(const uint8_t id, const uint32_t length, const uint16_t seq)
+{
+    FrameHeaderFields hdr;
+    hdr.version = EXT_HEADER_VERSION;
+    hdr.id = id;
+    hdr.length = length;
+    hdr.seq = seq;
+    hdr.crc = hdr.doCrc();
+    return hdr;
+}
+
+static void checkHeaderFieldsEqual(const FrameHeaderFields &a, const FrameHeaderFields &b)
+{
+    POTHOS_TEST_EQUAL(int(a.version), int(b.version));
+    POTHOS_TEST_EQUAL(int(a.id), int(b.id));
+    POTHOS_TEST_EQUAL(a.length, b.length);
+    POTHOS_TEST_EQUAL(a.seq, b.seq);
+    POTHOS_TEST_EQUAL(a.crc, b.crc);
+}
+
+POTHOS_TEST_BLOCK("/comms/tests", test_frame_header_crc16)
+{
+    //the CRC-16-CCITT check value with initial value 0xffff
+    const char *check = "123456789";
+    POTHOS_TEST_EQUAL(crc16(reinterpret_cast<const uint8_t *>(check), std::strlen(check)), 0x29b1);
+    POTHOS_TEST_EQUAL(crc16(nullptr, 0), 0xffff);
+}
+
+POTHOS_TEST_BLOCK("/comms/tests", test_frame_header_roundtrip)
+{
+    const std::vector<FrameHeaderFields> headers = {
+        extHeaderFields(0x55, 1, 0),
+        extHeaderFields(0x00, 4095, 1),
+        extHeaderFields(0xff, 4096, 0xffff),
+        extHeaderFields(0xa3, 0xffffff, 0x1234),
+        extHeaderFields(0x3c, 0x5a5a5a, 0x8001),
+    };
+
+    for (const auto &hdr : headers)
+    {
+        char bits[NUM_EXT_HEADER_BITS];
+        encodeExtHeaderWord(bits, hdr);
+        FrameHeaderFields out;
+        decodeExtHeaderWord(bits, out);
+        POTHOS_TEST_TRUE(not out.error);
+        POTHOS_TEST_TRUE(not extHeaderRejected(out));
+        checkHeaderFieldsEqual(out, hdr);
+
+        //any single flipped bit after the time sync is corrected
+        for (size_t i = 2; i < NUM_EXT_HEADER_BITS; i++)
+        {
+            bits[i] ^= 1;
+            decodeExtHeaderWord(bits, out);
+            bits[i] ^= 1;
+            POTHOS_TEST_TRUE(not extHeaderRejected(out));
+            checkHeaderFieldsEqual(out, hdr);
+        }
+    }
+
+    //the standard header round trip
+    FrameHeaderFields hdr;
+    hdr.id = 0x55;
+    hdr.length = 4095;
+    hdr.chksum = hdr.doChecksum();
+    char bits[NUM_HEADER_BITS];
+    encodeHeaderWord(bits, hdr);
+    FrameHeaderFields out;
+    decodeHeaderWord(bits, out);
+    POTHOS_TEST_TRUE(not out.error);
+    POTHOS_TEST_EQUAL(int(out.id), int(hdr.id));
+    POTHOS_TEST_EQUAL(out.length, hdr.length);
+    POTHOS_TEST_EQUAL(int(out.chksum), int(out.doChecksum()));
+}
+
+POTHOS_TEST_BLOCK("/comms/tests", test_frame_header_reject)
+{
+    const auto hdr = extHeaderFields(0xa3, 0x123456, 0x4321);
+    char bits[NUM_EXT_HEADER_BITS];
+    encodeExtHeaderWord(bits, hdr);
+
+    //two or three flipped bits in one codeword are beyond the Hamming correction:
+    //two are detected, and three are miscorrected into another nibble
+    //which the crc rejects, including a nibble of the version or the crc itself
+    for (size_t word = 2; word < NUM_EXT_HEADER_BITS; word += 8)
+    {
+        for (size_t i = 0; i < 8; i++)
+        {
+            for (size_t j = i+1; j < 8; j++)
+            {
+                FrameHeaderFields out;
+                bits[word+i] ^= 1; bits[word+j] ^= 1;
+                decodeExtHeaderWord(bits, out);
+                POTHOS_TEST_TRUE(out.error);
+
+                for (size_t k = j+1; k < 8; k++)
+                {
+                    bits[word+k] ^= 1;
+                    decodeExtHeaderWord(bits, out);
+                    bits[word+k] ^= 1;
+                    POTHOS_TEST_TRUE(extHeaderRejected(out));
+                }
+                bits[word+i] ^= 1; bits[word+j] ^= 1;
+            }
+        }
+    }
+
+    //an unknown version with a valid crc decodes without error but is rejected
+    auto future = hdr;
+    future.version = EXT_HEADER_VERSION+1;
+    future.crc = future.doCrc();
+    encodeExtHeaderWord(bits, future);
+    FrameHeaderFields out;
+    decodeExtHeaderWord(bits, out);
+    POTHOS_TEST_TRUE(not out.error);
+    checkHeaderFieldsEqual(out, future);
+    POTHOS_TEST_TRUE(extHeaderRejected(out));
+}
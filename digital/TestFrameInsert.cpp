@@ -0,0 +1,103 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#include <Pothos/Testing.hpp>
+#include <Pothos/Framework.hpp>
+#include <Pothos/Proxy.hpp>
+#include <complex>
+#include <string>
+#include <vector>
+#include <iostream>
+
+static Pothos::BufferChunk frameInsertPayload(const size_t length, const size_t seed)
+{
+    Pothos::BufferChunk payload("complex_float32", length);
+    auto p = payload.as<std::complex<float> *>();
+    for (size_t i = 0; i < length; i++) p[i] = std::complex<float>(float(i+seed), -float(seed));
+    return payload;
+}
+
+static void testFrameInsertPackets(const std::string &headerFormat)
+{
+    std::cout << "Testing frame insert packets with the " << headerFormat << " header" << std::endl;
+
+    auto streamFeeder = Pothos::BlockRegistry::make("/blocks/feeder_source", "complex_float32");
+    auto packetFeeder = Pothos::BlockRegistry::make("/blocks/feeder_source", "complex_float32");
+    auto streamInsert = Pothos::BlockRegistry::make("/comms/frame_insert", "complex_float32");
+    auto packetInsert = Pothos::BlockRegistry::make("/comms/frame_insert", "complex_float32");
+    for (auto insert : {streamInsert, packetInsert})
+    {
+        insert.call("setPreamble", std::vector<std::complex<float>>{1, 1, -1});
+        insert.call("setSymbolWidth", 5);
+        insert.call("setPaddingSize", 3);
+        insert.call("setHeaderFormat", headerFormat);
+    }
+    auto streamCollector = Pothos::BlockRegistry::make("/blocks/collector_sink", "complex_float32");
+    auto packetCollector = Pothos::BlockRegistry::make("/blocks/collector_sink", "complex_float32");
+
+    //the same frames back-to-back in the stream and as packets,
+    //the largest length is only valid for the extended header
+    std::vector<size_t> lengths = {30, 2, 4095, 17};
+    if (headerFormat == "EXTENDED") lengths.push_back(4096);
+    size_t index = 0;
+    for (size_t n = 0; n < lengths.size(); n++)
+    {
+        const auto payload = frameInsertPayload(lengths[n], n);
+        streamFeeder.call("feedBuffer", payload);
+        streamFeeder.call("feedLabel", Pothos::Label("frameStart", lengths[n], index));
+        streamFeeder.call("feedLabel", Pothos::Label("frameEnd", lengths[n], index+lengths[n]-1));
+        index += lengths[n];
+
+        Pothos::Packet packet;
+        packet.payload = payload;
+        packetFeeder.call("feedPacket", packet);
+
+        //packets which are rejected without a burst
+        if (n != 1) continue;
+        Pothos::Packet wrongType;
+        wrongType.payload = Pothos::BufferChunk("complex_float64", 10);
+        packetFeeder.call("feedPacket", wrongType);
+        if (headerFormat != "STANDARD") continue;
+        Pothos::Packet tooLong;
+        tooLong.payload = frameInsertPayload(4096, n);
+        packetFeeder.call("feedPacket", tooLong);
+    }
+
+    {
+        Pothos::Topology topology;
+        topology.connect(streamFeeder, 0, streamInsert, 0);
+        topology.connect(streamInsert, 0, streamCollector, 0);
+        topology.connect(packetFeeder, 0, packetInsert, 0);
+        topology.connect(packetInsert, 0, packetCollector, 0);
+        topology.commit();
+        POTHOS_TEST_TRUE(topology.waitInactive(0.01));
+    }
+
+    //the bursts are identical to the frames inserted into the stream
+    Pothos::BufferChunk streamOut = streamCollector.call("getBuffer");
+    Pothos::BufferChunk packetOut = packetCollector.call("getBuffer");
+    POTHOS_TEST_EQUAL(packetOut.elements(), streamOut.elements());
+    auto pStream = streamOut.as<const std::complex<float> *>();
+    auto pPacket = packetOut.as<const std::complex<float> *>();
+    for (size_t i = 0; i < streamOut.elements(); i++)
+    {
+        POTHOS_TEST_EQUAL(pPacket[i], pStream[i]);
+    }
+
+    //with frame labels at the same positions
+    const auto streamLabels = streamCollector.call<std::vector<Pothos::Label>>("getLabels");
+    const auto packetLabels = packetCollector.call<std::vector<Pothos::Label>>("getLabels");
+    POTHOS_TEST_EQUAL(packetLabels.size(), 2*lengths.size());
+    POTHOS_TEST_EQUAL(packetLabels.size(), streamLabels.size());
+    for (size_t i = 0; i < packetLabels.size(); i++)
+    {
+        POTHOS_TEST_EQUAL(packetLabels[i].id, streamLabels[i].id);
+        POTHOS_TEST_EQUAL(packetLabels[i].index, streamLabels[i].index);
+        POTHOS_TEST_EQUAL(packetLabels[i].data.convert<size_t>(), streamLabels[i].data.convert<size_t>());
+    }
+}
+
+POTHOS_TEST_BLOCK("/comms/tests", test_frame_insert_packets)
+{
+    testFrameInsertPackets("STANDARD");
+    testFrameInsertPackets("EXTENDED");
+}
@@ -0,0 +1,227 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#include <Pothos/Testing.hpp>
+#include <Pothos/Framework.hpp>
+#include <Pothos/Proxy.hpp>
+#include <complex>
+#include <cstdint>
+#include <cmath>
+#include <string>
+#include <algorithm> //min, stable_sort
+#include <type_traits>
+#include <vector>
+#include <iostream>
+
+//frame configuration shared by the inserter and the sync
+static const std::vector<double> frameTestPreamble = {1, 1, 1, -1, 1};
+static const size_t frameTestSymbolWidth = 20;
+static const size_t frameTestDataWidth = 4;
+static const std::vector<size_t> frameTestLengths = {50, 173, 20, 301, 97};
+
+/***********************************************************************
+ * Insert back-to-back frames of QPSK symbols,
+ * then hold each symbol over the data width and rotate the carrier
+ * to create the input for the frame sync
+ **********************************************************************/
+static std::vector<std::complex<double>> frameTestSignal(void)
+{
+    auto feeder = Pothos::BlockRegistry::make("/blocks/feeder_source", "complex_float32");
+    auto inserter = Pothos::BlockRegistry::make("/comms/frame_insert", "complex_float32");
+    inserter.call("setPreamble", frameTestPreamble);
+    inserter.call("setSymbolWidth", frameTestSymbolWidth);
+    inserter.call("setPaddingSize", 8);
+    auto collector = Pothos::BlockRegistry::make("/blocks/collector_sink", "complex_float32");
+
+    //idle symbols before the first frame and after the last
+    const size_t idle = 100;
+    size_t total = 2*idle;
+    for (const size_t length : frameTestLengths) total += length;
+    auto buffIn = Pothos::BufferChunk("complex_float32", total);
+    auto pIn = buffIn.as<std::complex<float> *>();
+    for (size_t i = 0; i < total; i++) pIn[i] = 0;
+
+    size_t index = idle;
+    for (const size_t length : frameTestLengths)
+    {
+        for (size_t i = 0; i < length; i++)
+        {
+            const size_t n = (index+i)*7;
+            pIn[index+i] = std::complex<float>(((n/3)%2)?0.7f:-0.7f, ((n/5)%2)?0.7f:-0.7f);
+        }
+        feeder.call("feedLabel", Pothos::Label("frameStart", length, index));
+        feeder.call("feedLabel", Pothos::Label("frameEnd", length, index+length-1));
+        index += length;
+    }
+    feeder.call("feedBuffer", buffIn);
+
+    {
+        Pothos::Topology topology;
+        topology.connect(feeder, 0, inserter, 0);
+        topology.connect(inserter, 0, collector, 0);
+        topology.commit();
+        POTHOS_TEST_TRUE(topology.waitInactive(0.01));
+    }
+
+    Pothos::BufferChunk buffOut = collector.call("getBuffer");
+    auto pOut = buffOut.as<const std::complex<float> *>();
+    std::vector<std::complex<double>> signal;
+    double phase = 0.7;
+    for (size_t i = 0; i < buffOut.elements(); i++)
+    {
+        for (size_t j = 0; j < frameTestDataWidth; j++)
+        {
+            signal.push_back(std::complex<double>(pOut[i])*std::polar(0.8, phase));
+            phase += 0.002;
+        }
+    }
+    return signal;
+}
+
+struct FrameSyncTestResult
+{
+    std::vector<std::complex<double>> payload;
+    std::vector<Pothos::Label> labels;
+};
+
+template <typename Type>
+static Type frameTestSample(const std::complex<double> &x, Type *)
+{
+    return Type(x);
+}
+
+static std::complex<int16_t> frameTestSample(const std::complex<double> &x, std::complex<int16_t> *)
+{
+    return std::complex<int16_t>(int16_t(std::lround(x.real()*8000)), int16_t(std::lround(x.imag()*8000)));
+}
+
+/***********************************************************************
+ * Run the frame sync over the signal fed in chunks of the given size
+ **********************************************************************/
+template <typename Type>
+static FrameSyncTestResult frameSyncRun(
+    const std::vector<std::complex<double>> &signal,
+    const size_t chunkSize,
+    const size_t searchThreads,
+    const bool coarseSearch,
+    const std::string &scaleId)
+{
+    const Pothos::DType dtype(typeid(Type));
+    auto feeder = Pothos::BlockRegistry::make("/blocks/feeder_source", dtype);
+    auto sync = Pothos::BlockRegistry::make("/comms/frame_sync", dtype);
+    sync.call("setOutputMode", "RAW");
+    sync.call("setPreamble", frameTestPreamble);
+    sync.call("setSymbolWidth", frameTestSymbolWidth);
+    sync.call("setDataWidth", frameTestDataWidth);
+    sync.call("setFrameStartId", "frameStart");
+    sync.call("setFrameEndId", "frameEnd");
+    sync.call("setPhaseOffsetID", "phaseOffset");
+    sync.call("setScaleID", scaleId);
+    sync.call("setSearchThreads", searchThreads);
+    sync.call("setCoarseSearch", coarseSearch);
+    auto collector = Pothos::BlockRegistry::make("/blocks/collector_sink", dtype);
+
+    for (size_t offset = 0; offset < signal.size(); offset += chunkSize)
+    {
+        const size_t numElems = std::min(chunkSize, signal.size()-offset);
+        auto buffIn = Pothos::BufferChunk(dtype, numElems);
+        auto pIn = buffIn.as<Type *>();
+        for (size_t i = 0; i < numElems; i++)
+        {
+            pIn[i] = frameTestSample(signal[offset+i], static_cast<Type *>(nullptr));
+        }
+        feeder.call("feedBuffer", buffIn);
+    }
+
+    {
+        Pothos::Topology topology;
+        topology.connect(feeder, 0, sync, 0);
+        topology.connect(sync, 0, collector, 0);
+        topology.commit();
+        POTHOS_TEST_TRUE(topology.waitInactive(0.01));
+    }
+
+    FrameSyncTestResult result;
+    Pothos::BufferChunk buffOut = collector.call("getBuffer");
+    auto pOut = buffOut.as<const Type *>();
+    for (size_t i = 0; i < buffOut.elements(); i++)
+    {
+        result.payload.emplace_back(double(pOut[i].real()), double(pOut[i].imag()));
+    }
+    //labels past the end of a buffer are delivered later, so order by index
+    result.labels = collector.call<std::vector<Pothos::Label>>("getLabels");
+    std::stable_sort(result.labels.begin(), result.labels.end(), [](const Pothos::Label &a, const Pothos::Label &b)
+    {
+        return a.index < b.index or (a.index == b.index and a.id < b.id);
+    });
+    return result;
+}
+
+template <typename Type>
+static void testFrameInsertToSync(const std::vector<std::complex<double>> &signal, const std::string &scaleId)
+{
+    const Pothos::DType dtype(typeid(Type));
+    std::cout << "Testing frame insert to sync on " << dtype.toString()
+        << (scaleId.empty()?"":" with scale ID") << std::endl;
+
+    //the whole signal at once with a single search thread is the reference
+    const auto expected = frameSyncRun<Type>(signal, signal.size(), 1, false, scaleId);
+
+    //every frame is found with its length, and a label for each frame
+    size_t numFrames = 0, numPayload = 0;
+    for (const auto &label : expected.labels)
+    {
+        if (label.id != "frameStart") continue;
+        POTHOS_TEST_TRUE(numFrames < frameTestLengths.size());
+        POTHOS_TEST_EQUAL(label.data.template convert<size_t>(), frameTestLengths[numFrames]);
+        POTHOS_TEST_EQUAL(label.index, numPayload);
+        numPayload += frameTestLengths[numFrames++]*frameTestDataWidth;
+    }
+    POTHOS_TEST_EQUAL(numFrames, frameTestLengths.size());
+    POTHOS_TEST_EQUAL(expected.payload.size(), numPayload);
+    POTHOS_TEST_EQUAL(expected.labels.size(), numFrames*(scaleId.empty()?3:4));
+
+    //the fixed point search is exact, the floating point sums depend on the buffer boundaries
+    const bool fixedPoint = std::is_same<Type, std::complex<int16_t>>::value;
+    const double tol = fixedPoint?0.0:1e-4;
+
+    //small chunks split the frames, and leave a correlation peak pending over calls
+    for (const size_t chunkSize : {997, 256, 61})
+    {
+        for (const size_t searchThreads : {1, 3})
+        {
+            for (const bool coarseSearch : {false, true})
+            {
+                const auto result = frameSyncRun<Type>(signal, chunkSize, searchThreads, coarseSearch, scaleId);
+                POTHOS_TEST_EQUAL(result.labels.size(), expected.labels.size());
+                for (size_t i = 0; i < result.labels.size(); i++)
+                {
+                    const auto &label = result.labels[i];
+                    const auto &expectedLabel = expected.labels[i];
+                    POTHOS_TEST_EQUAL(label.id, expectedLabel.id);
+                    POTHOS_TEST_EQUAL(label.index, expectedLabel.index);
+                    POTHOS_TEST_EQUAL(label.width, expectedLabel.width);
+                    if (label.id == "frameStart" or label.id == "frameEnd")
+                    {
+                        POTHOS_TEST_EQUAL(label.data.template convert<size_t>(), expectedLabel.data.template convert<size_t>());
+                    }
+                    else POTHOS_TEST_CLOSE(label.data.template convert<double>(), expectedLabel.data.template convert<double>(), tol);
+                }
+                POTHOS_TEST_EQUAL(result.payload.size(), expected.payload.size());
+                for (size_t i = 0; i < result.payload.size(); i++)
+                {
+                    POTHOS_TEST_CLOSE(std::abs(result.payload[i]-expected.payload[i]), 0.0, tol);
+                }
+            }
+        }
+    }
+}
+
+POTHOS_TEST_BLOCK("/comms/tests", test_frame_insert_to_sync)
+{
+    const auto signal = frameTestSignal();
+    for (const std::string scaleId : {"", "scale"})
+    {
+        testFrameInsertToSync<std::complex<float>>(signal, scaleId);
+        testFrameInsertToSync<std::complex<int16_t>>(signal, scaleId);
+    }
+}
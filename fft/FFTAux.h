@@ -1,10 +1,33 @@
 #pragma once
 
 #include <complex>
+#include <memory>
+#include <typeinfo>
 
+#include "FFTPlanCache.hpp"
 #include "kissfft.hh"
 #include "kiss_fft.h"
 
+/*!
+ * Typed access to the process-wide FFT plan cache in CommsFFTPlans,
+ * so that every FFTAux in every module with the same plan type,
+ * which is the scalar type, size, and direction, shares one plan.
+ * Identical transforms share one plan with its twiddle table,
+ * which transform() only reads, so the plan needs no locking after it is made.
+ * The plans are reference counted and freed with their last user.
+ */
+template<typename Plan>
+class FFTPlanCache {
+public:
+    //! Get the plan for numBins and inverse, or a new plan from make()
+    template<typename MakeFcn>
+    static std::shared_ptr<Plan> get(size_t numBins, bool inverse, MakeFcn make) {
+        //the pointer type names the plan type, which may be incomplete like kiss_fft_state
+        return std::static_pointer_cast<Plan>(getFFTPlan(typeid(Plan *).name(), numBins, inverse,
+            [&]() -> std::shared_ptr<void> { return make(); }));
+    }
+};
+
 template<typename Type>
 class FFTAux {
 private:
@@ -16,33 +39,45 @@ private:
 template<typename Type>
 class FFTAux<std::complex<Type>> {
 public:
-    inline FFTAux(size_t numBins, bool inverse) : _fftFloat(numBins, inverse) {}
+    inline FFTAux(size_t numBins, bool inverse) :
+        _fftFloat(FFTPlanCache<kissfft<Type>>::get(numBins, inverse, [=]() {
+            return std::shared_ptr<kissfft<Type>>(new kissfft<Type>(numBins, inverse));
+        })) {}
 
     inline void transform(const std::complex<Type> *input, std::complex<Type> *output) {
-        _fftFloat.transform(input, output);
+        _fftFloat->transform(input, output);
+    }
+
+    //! The shared plan, to check the sharing
+    inline std::shared_ptr<const void> plan(void) const {
+        return _fftFloat;
     }
 
 private:
-    kissfft<Type> _fftFloat;
+    std::shared_ptr<kissfft<Type>> _fftFloat;
 };
 
 template<>
 class FFTAux<std::complex<kiss_fft_scalar>> {
 public:
-    inline FFTAux(size_t numBins, bool inverse) : _fftFixed(nullptr) {
-        _fftFixed = kiss_fft_alloc(numBins, inverse, nullptr, nullptr);
-    }
-
-    inline ~FFTAux() {
-        kiss_fft_free(_fftFixed);
-    }
+    inline FFTAux(size_t numBins, bool inverse) :
+        _fftFixed(FFTPlanCache<kiss_fft_state>::get(numBins, inverse, [=]() {
+            return std::shared_ptr<kiss_fft_state>(
+                kiss_fft_alloc(numBins, inverse, nullptr, nullptr),
+                [](kiss_fft_cfg cfg) { kiss_fft_free(cfg); });
+        })) {}
 
     inline void transform(const std::complex<kiss_fft_scalar> *input, std::complex<kiss_fft_scalar> *output) {
-        kiss_fft(_fftFixed,
+        kiss_fft(_fftFixed.get(),
             reinterpret_cast<const kiss_fft_cpx*>(input),
             reinterpret_cast<kiss_fft_cpx*>(output));
     }
 
+    //! The shared plan, to check the sharing
+    inline std::shared_ptr<const void> plan(void) const {
+        return _fftFixed;
+    }
+
 private:
-    kiss_fft_cfg _fftFixed;
+    std::shared_ptr<kiss_fft_state> _fftFixed;
 };
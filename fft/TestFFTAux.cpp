@@ -0,0 +1,64 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#include "FFTAux.h"
+#include <Pothos/Testing.hpp>
+#include <complex>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+POTHOS_TEST_BLOCK("/comms/tests", test_fft_aux_plan_cache)
+{
+    const size_t numPlans = getFFTPlanCacheSize();
+    std::weak_ptr<const void> plan;
+    {
+        //the same size and direction share a plan
+        FFTAux<std::complex<float>> a(64, false);
+        FFTAux<std::complex<float>> b(64, false);
+        POTHOS_TEST_TRUE(a.plan() == b.plan());
+        POTHOS_TEST_EQUAL(getFFTPlanCacheSize(), numPlans+1);
+        plan = a.plan();
+
+        //another size, direction, or type has its own plan
+        FFTAux<std::complex<float>> c(128, false);
+        FFTAux<std::complex<float>> d(64, true);
+        FFTAux<std::complex<double>> e(64, false);
+        POTHOS_TEST_TRUE(c.plan() != a.plan());
+        POTHOS_TEST_TRUE(d.plan() != a.plan());
+        POTHOS_TEST_TRUE(e.plan() != a.plan());
+        POTHOS_TEST_EQUAL(getFFTPlanCacheSize(), numPlans+4);
+    }
+
+    //the plan is freed and removed after both users are destroyed
+    POTHOS_TEST_TRUE(plan.expired());
+    POTHOS_TEST_EQUAL(getFFTPlanCacheSize(), numPlans);
+
+    //and a new user makes a new plan
+    FFTAux<std::complex<float>> a(64, false);
+    POTHOS_TEST_EQUAL(getFFTPlanCacheSize(), numPlans+1);
+}
+
+POTHOS_TEST_BLOCK("/comms/tests", test_fft_aux_fixed_copy)
+{
+    const size_t numPlans = getFFTPlanCacheSize();
+    std::vector<std::complex<int16_t>> input(32), out0(32), out1(32);
+    for (size_t i = 0; i < input.size(); i++) input[i] = std::complex<int16_t>(int16_t(i*100), int16_t(-int(i)*50));
+
+    std::weak_ptr<const void> plan;
+    {
+        //a copy shares the fixed point plan, and transforms the same
+        std::unique_ptr<FFTAux<std::complex<int16_t>>> a(new FFTAux<std::complex<int16_t>>(input.size(), false));
+        FFTAux<std::complex<int16_t>> b(*a);
+        POTHOS_TEST_TRUE(a->plan() == b.plan());
+        plan = b.plan();
+        a->transform(input.data(), out0.data());
+        a.reset();
+        POTHOS_TEST_TRUE(not plan.expired());
+        b.transform(input.data(), out1.data());
+        POTHOS_TEST_EQUALV(out0, out1);
+    }
+
+    //the plan is freed once, after the copy
+    POTHOS_TEST_TRUE(plan.expired());
+    POTHOS_TEST_EQUAL(getFFTPlanCacheSize(), numPlans);
+}
@@ -0,0 +1,444 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#include "CascadedIntegratorComb.hpp"
+#include <Pothos/Framework.hpp>
+#include <spuce/filters/design_window.h>
+#include <cstdint>
+#include <complex>
+#include <cmath>
+#include <algorithm>
+
+/***********************************************************************
+ * Compensation filter design:
+ * Frequency sampling of the inverse CIC response over the pass band,
+ * windowed and normalized for unity gain at DC.
+ * Frequencies are in cycles per sample at the low rate.
+ **********************************************************************/
+static std::vector<double> designCICCompensation(
+    const size_t order, const size_t rate, const size_t delay,
+    const size_t numTaps, const double cutoff)
+{
+    static const size_t numPoints = 1024;
+    const double centre = (numTaps-1)/2.0;
+    std::vector<double> taps(numTaps, 0.0);
+    for (size_t p = 0; p < numPoints; p++)
+    {
+        const double f = cutoff*(p+0.5)/numPoints;
+        //the combs run at the high rate, where the frequency is f/rate
+        const double h = std::pow(std::sin(M_PI*delay*f)/(rate*delay*std::sin(M_PI*f/rate)), double(order));
+        const double a = 2*cutoff/numPoints/h;
+        for (size_t n = 0; n < numTaps; n++) taps[n] += a*std::cos(2*M_PI*f*(n-centre));
+    }
+
+    const auto window = spuce::design_window("hamming", numTaps);
+    double sum = 0.0;
+    for (size_t n = 0; n < numTaps; n++) sum += (taps[n] *= window[n]);
+    for (auto &tap : taps) tap /= sum;
+    return taps;
+}
+
+/***********************************************************************
+ * |PothosDoc CIC Filter
+ *
+ * The cascaded integrator comb filter decimates or interpolates
+ * an input element stream from port 0 by a large integer rate
+ * to produce an output element stream on port 0.
+ * The filter uses only additions and subtractions in integer accumulators,
+ * which makes it much cheaper than a FIR filter for high rate changes.
+ *
+ * <a href="https://en.wikipedia.org/wiki/Cascaded_integrator%E2%80%93comb_filter">
+ * https://en.wikipedia.org/wiki/Cascaded_integrator%E2%80%93comb_filter</a>
+ *
+ * The filter gain (rate*delay)^order is removed from the output,
+ * and the accumulators must be wide enough for the bit growth:
+ * the element bits plus order*log2(rate*delay) cannot exceed 64.
+ *
+ * <h2>Compensation</h2>
+ *
+ * The CIC response droops across the pass band like a sinc to the power of the order.
+ * An optional compensation FIR filter with the inverse response runs at the low rate:
+ * after the combs when decimating and before the combs when interpolating.
+ * The compensation filter is the only part of the block which uses multiplies.
+ *
+ * |category /Filter
+ * |keywords filter cic decimate interpolate resample integrator comb
+ *
+ * |param dtype[Data Type] The data type of the input and output element stream.
+ * |widget DTypeChooser(int=1,cint=1)
+ * |default "complex_int16"
+ * |preview disable
+ *
+ * |param mode[Mode] Decimate or interpolate by the rate.
+ * |option [Decimate] "DECIMATE"
+ * |option [Interpolate] "INTERPOLATE"
+ * |default "DECIMATE"
+ *
+ * |param order[Order] The number of integrator and comb stages.
+ * A higher order increases the alias rejection and the pass band droop.
+ * |default 4
+ * |widget SpinBox(minimum=1)
+ *
+ * |param rate[Rate] The decimation or interpolation rate.
+ * |default 64
+ * |widget SpinBox(minimum=1)
+ *
+ * |param diffDelay[Differential Delay] The delay of each comb stage in low rate samples.
+ * |default 1
+ * |widget SpinBox(minimum=1)
+ * |preview valid
+ *
+ * |param compTaps[Comp. Taps] The number of compensation filter taps.
+ * Zero (default) disables the compensation filter.
+ * |default 0
+ * |widget SpinBox(minimum=0)
+ * |preview valid
+ * |tab Compensation
+ *
+ * |param compCutoff[Comp. Cutoff] The pass band edge of the compensation filter.
+ * The cutoff is a fraction of the low sample rate, and less than 0.5/diffDelay.
+ * |default 0.2
+ * |preview valid
+ * |tab Compensation
+ *
+ * |factory /comms/cic_filter(dtype)
+ * |setter setMode(mode)
+ * |setter setOrder(order)
+ * |setter setRate(rate)
+ * |setter setDiffDelay(diffDelay)
+ * |setter setCompTaps(compTaps)
+ * |setter setCompCutoff(compCutoff)
+ **********************************************************************/
+template <typename Type, typename AccType, typename CompType>
+class CICFilter : public Pothos::Block
+{
+public:
+    CICFilter(void):
+        _interp(false),
+        _order(4),
+        _rate(64),
+        _diffDelay(1),
+        _compTaps(0),
+        _compCutoff(0.2),
+        _invGain(1.0),
+        _phase(0)
+    {
+        this->setupInput(0, typeid(Type));
+        this->setupOutput(0, typeid(Type));
+        this->registerCall(this, POTHOS_FCN_TUPLE(CICFilter, setMode));
+        this->registerCall(this, POTHOS_FCN_TUPLE(CICFilter, getMode));
+        this->registerCall(this, POTHOS_FCN_TUPLE(CICFilter, setOrder));
+        this->registerCall(this, POTHOS_FCN_TUPLE(CICFilter, getOrder));
+        this->registerCall(this, POTHOS_FCN_TUPLE(CICFilter, setRate));
+        this->registerCall(this, POTHOS_FCN_TUPLE(CICFilter, getRate));
+        this->registerCall(this, POTHOS_FCN_TUPLE(CICFilter, setDiffDelay));
+        this->registerCall(this, POTHOS_FCN_TUPLE(CICFilter, getDiffDelay));
+        this->registerCall(this, POTHOS_FCN_TUPLE(CICFilter, setCompTaps));
+        this->registerCall(this, POTHOS_FCN_TUPLE(CICFilter, getCompTaps));
+        this->registerCall(this, POTHOS_FCN_TUPLE(CICFilter, setCompCutoff));
+        this->registerCall(this, POTHOS_FCN_TUPLE(CICFilter, getCompCutoff));
+        this->updateInternals(); //initial state
+    }
+
+    void setMode(const std::string &mode)
+    {
+        if (mode == "DECIMATE") _interp = false;
+        else if (mode == "INTERPOLATE") _interp = true;
+        else throw Pothos::InvalidArgumentException("CICFilter::setMode()", "unknown mode: " + mode);
+        this->updateInternals();
+    }
+
+    std::string getMode(void) const
+    {
+        return _interp?"INTERPOLATE":"DECIMATE";
+    }
+
+    void setOrder(const size_t order)
+    {
+        if (order == 0) throw Pothos::InvalidArgumentException("CICFilter::setOrder()", "order cannot be 0");
+        _order = order;
+        this->updateInternals();
+    }
+
+    size_t getOrder(void) const
+    {
+        return _order;
+    }
+
+    void setRate(const size_t rate)
+    {
+        if (rate == 0) throw Pothos::InvalidArgumentException("CICFilter::setRate()", "rate cannot be 0");
+        _rate = rate;
+        this->updateInternals();
+    }
+
+    size_t getRate(void) const
+    {
+        return _rate;
+    }
+
+    void setDiffDelay(const size_t delay)
+    {
+        if (delay == 0) throw Pothos::InvalidArgumentException("CICFilter::setDiffDelay()", "differential delay cannot be 0");
+        _diffDelay = delay;
+        this->updateInternals();
+    }
+
+    size_t getDiffDelay(void) const
+    {
+        return _diffDelay;
+    }
+
+    void setCompTaps(const size_t numTaps)
+    {
+        _compTaps = numTaps;
+        this->updateInternals();
+    }
+
+    size_t getCompTaps(void) const
+    {
+        return _compTaps;
+    }
+
+    void setCompCutoff(const double cutoff)
+    {
+        if (cutoff <= 0.0 or cutoff >= 0.5) throw Pothos::InvalidArgumentException("CICFilter::setCompCutoff()", "cutoff must be between 0.0 and 0.5");
+        _compCutoff = cutoff;
+        this->updateInternals();
+    }
+
+    double getCompCutoff(void) const
+    {
+        return _compCutoff;
+    }
+
+    void activate(void)
+    {
+        this->checkBitGrowth();
+        this->resetFilters();
+    }
+
+    void work(void)
+    {
+        auto inPort = this->input(0);
+        auto outPort = this->output(0);
+
+        //limit the input to the elements that produce outputs into the available space
+        size_t numIn = inPort->elements();
+        const size_t outputAvailable = outPort->elements();
+        if (_interp) numIn = std::min(numIn, outputAvailable/_rate);
+        else numIn = std::min(numIn, outputAvailable*_rate + (_rate-1-_phase));
+        if (numIn == 0) return;
+
+        const Type *in = inPort->buffer();
+        Type *out = outPort->buffer();
+        const size_t numOut = _interp?this->interpolate(in, numIn, out):this->decimate(in, numIn, out);
+
+        inPort->consume(numIn);
+        outPort->produce(numOut);
+    }
+
+    void propagateLabels(const Pothos::InputPort *port)
+    {
+        const size_t L = _interp?_rate:1, M = _interp?1:_rate;
+        auto outputPort = this->output(0);
+        for (const auto &label : port->labels())
+        {
+            auto newLabel = label.toAdjusted(L, M);
+            if (label.id == "rxRate" and label.data.type() == typeid(double))
+            {
+                newLabel.data = Pothos::Object((double(label.data)*L)/M);
+            }
+            outputPort->postLabel(std::move(newLabel));
+        }
+    }
+
+private:
+    size_t decimate(const Type *in, const size_t numIn, Type *out)
+    {
+        _accBuff.resize(numIn);
+        for (size_t i = 0; i < numIn; i++) _accBuff[i] = toAcc(in[i]);
+        _cic.integrate(_accBuff.data(), numIn);
+
+        //every rate-th integrator output goes through the combs
+        size_t numOut = 0;
+        for (size_t i = _rate-1-_phase; i < numIn; i += _rate)
+        {
+            const auto c = _cic.comb(_accBuff[i]);
+            if (_taps.empty()) out[numOut] = toOut(c, _invGain);
+            else _compBuff.push_back(toComp(c, _invGain));
+            numOut++;
+        }
+        _phase = (_phase + numIn) % _rate;
+
+        if (not _taps.empty()) this->compensate(out, [](const CompType &y){return toOut(y);});
+        return numOut;
+    }
+
+    size_t interpolate(const Type *in, const size_t numIn, Type *out)
+    {
+        if (not _taps.empty())
+        {
+            for (size_t i = 0; i < numIn; i++) _compBuff.push_back(toComp(toAcc(in[i]), 1.0));
+            _combIn.resize(numIn);
+            this->compensate(_combIn.data(), [](const CompType &y){return toAcc(y);});
+        }
+
+        //the comb outputs are zero stuffed into the integrators
+        const size_t numOut = numIn*_rate;
+        _accBuff.resize(numOut);
+        std::fill(_accBuff.begin(), _accBuff.end(), AccType(0));
+        for (size_t i = 0; i < numIn; i++)
+        {
+            _accBuff[i*_rate] = _cic.comb(_taps.empty()?toAcc(in[i]):_combIn[i]);
+        }
+        _cic.integrate(_accBuff.data(), numOut);
+
+        for (size_t i = 0; i < numOut; i++) out[i] = toOut(_accBuff[i], _invGain);
+        return numOut;
+    }
+
+    //! Filter the new compensation inputs after the history and keep the history tail
+    template <typename OutType, typename Convert>
+    void compensate(OutType *out, const Convert &convert)
+    {
+        const size_t K = _taps.size();
+        const size_t numOut = _compBuff.size()-(K-1);
+        for (size_t m = 0; m < numOut; m++)
+        {
+            CompType y(0);
+            const CompType *x = _compBuff.data()+m;
+            for (size_t k = 0; k < K; k++) y += _taps[k]*x[k];
+            out[m] = convert(y);
+        }
+        _compBuff.erase(_compBuff.begin(), _compBuff.begin()+numOut);
+    }
+
+    void checkBitGrowth(void) const
+    {
+        const size_t elemBits = 8*sizeof(Type)*sizeof(int64_t)/sizeof(AccType);
+        const double growth = _order*std::log2(double(_rate*_diffDelay)) - (_interp?std::log2(double(_rate)):0.0);
+        const size_t bits = elemBits + size_t(std::ceil(growth)) + (_taps.empty()?0:1);
+        if (bits > 64) throw Pothos::InvalidArgumentException("CICFilter::activate()",
+            "accumulator needs "+std::to_string(bits)+" bits, reduce the order or rate");
+    }
+
+    void updateInternals(void)
+    {
+        if (_compTaps != 0 and _compCutoff*_diffDelay >= 0.5)
+        {
+            throw Pothos::InvalidArgumentException("CICFilter::updateInternals()", "compensation cutoff must be less than 0.5/diffDelay");
+        }
+
+        //the gain of the integrators and combs, less the zero stuffing of the interpolator
+        double gain = std::pow(double(_rate*_diffDelay), double(_order));
+        if (_interp) gain /= _rate;
+        _invGain = 1.0/gain;
+
+        //reversed compensation taps for the dot product over the history
+        _taps.clear();
+        if (_compTaps != 0)
+        {
+            _taps = designCICCompensation(_order, _rate, _diffDelay, _compTaps, _compCutoff);
+            std::reverse(_taps.begin(), _taps.end());
+        }
+
+        if (this->isActive()) this->checkBitGrowth();
+        this->resetFilters();
+    }
+
+    void resetFilters(void)
+    {
+        _cic.resize(_order, _diffDelay);
+        _phase = 0;
+        _compBuff.clear();
+        if (not _taps.empty()) _compBuff.resize(_taps.size()-1, CompType(0));
+    }
+
+    /*******************************************************************
+     * Conversions between the stream, accumulator, and compensation types
+     ******************************************************************/
+    template <typename T>
+    static int64_t toAcc(const T &x)
+    {
+        return int64_t(x);
+    }
+
+    template <typename T>
+    static std::complex<int64_t> toAcc(const std::complex<T> &x)
+    {
+        return std::complex<int64_t>(int64_t(x.real()), int64_t(x.imag()));
+    }
+
+    static int64_t toAcc(const double &x)
+    {
+        return std::llround(x);
+    }
+
+    static std::complex<int64_t> toAcc(const std::complex<double> &x)
+    {
+        return std::complex<int64_t>(std::llround(x.real()), std::llround(x.imag()));
+    }
+
+    //scale by the inverse gain and round, the output type is integral
+    static Type toOut(const int64_t &x, const double &invGain)
+    {
+        return Type(std::llround(x*invGain));
+    }
+
+    static Type toOut(const std::complex<int64_t> &x, const double &invGain)
+    {
+        typedef typename Type::value_type T;
+        return Type(T(std::llround(x.real()*invGain)), T(std::llround(x.imag()*invGain)));
+    }
+
+    static Type toOut(const double &x)
+    {
+        return Type(std::llround(x));
+    }
+
+    static Type toOut(const std::complex<double> &x)
+    {
+        typedef typename Type::value_type T;
+        return Type(T(std::llround(x.real())), T(std::llround(x.imag())));
+    }
+
+    static double toComp(const int64_t &x, const double &invGain)
+    {
+        return x*invGain;
+    }
+
+    static std::complex<double> toComp(const std::complex<int64_t> &x, const double &invGain)
+    {
+        return std::complex<double>(x.real()*invGain, x.imag()*invGain);
+    }
+
+    bool _interp;
+    size_t _order;
+    size_t _rate;
+    size_t _diffDelay;
+    size_t _compTaps;
+    double _compCutoff;
+    double _invGain;
+    size_t _phase;
+    CascadedIntegratorComb<AccType> _cic;
+    std::vector<double> _taps;
+    std::vector<CompType> _compBuff;
+    std::vector<AccType> _accBuff;
+    std::vector<AccType> _combIn;
+};
+
+/***********************************************************************
+ * registration
+ **********************************************************************/
+static Pothos::Block *CICFilterFactory(const Pothos::DType &dtype)
+{
+    #define ifTypeDeclareFactory(Type) \
+        if (dtype == Pothos::DType(typeid(Type))) return new CICFilter<Type, int64_t, double>(); \
+        if (dtype == Pothos::DType(typeid(std::complex<Type>))) return new CICFilter<std::complex<Type>, std::complex<int64_t>, std::complex<double>>();
+    ifTypeDeclareFactory(int32_t);
+    ifTypeDeclareFactory(int16_t);
+    ifTypeDeclareFactory(int8_t);
+    throw Pothos::InvalidArgumentException("CICFilterFactory("+dtype.toString()+")", "unsupported type");
+}
+static Pothos::BlockRegistry registerCICFilter(
+    "/comms/cic_filter", &CICFilterFactory);
@@ -0,0 +1,107 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#pragma once
+#include <complex>
+#include <vector>
+#include <cstddef>
+#include <type_traits>
+
+/*!
+ * Modular add and subtract for the CIC accumulators.
+ * Integer accumulators wrap around on overflow, which is harmless
+ * as long as the final output of the combs is within range.
+ */
+template <typename Type>
+typename std::enable_if<std::is_integral<Type>::value, Type>::type cicAdd(const Type &a, const Type &b)
+{
+    typedef typename std::make_unsigned<Type>::type UType;
+    return Type(UType(a) + UType(b));
+}
+
+template <typename Type>
+typename std::enable_if<std::is_integral<Type>::value, Type>::type cicSub(const Type &a, const Type &b)
+{
+    typedef typename std::make_unsigned<Type>::type UType;
+    return Type(UType(a) - UType(b));
+}
+
+template <typename Type>
+std::complex<Type> cicAdd(const std::complex<Type> &a, const std::complex<Type> &b)
+{
+    return std::complex<Type>(cicAdd(a.real(), b.real()), cicAdd(a.imag(), b.imag()));
+}
+
+template <typename Type>
+std::complex<Type> cicSub(const std::complex<Type> &a, const std::complex<Type> &b)
+{
+    return std::complex<Type>(cicSub(a.real(), b.real()), cicSub(a.imag(), b.imag()));
+}
+
+/*!
+ * Cascaded integrator comb processing unit.
+ * The integrators run at the high rate and the combs at the low rate,
+ * the caller decides which samples pass between the two sections.
+ * \see https://en.wikipedia.org/wiki/Cascaded_integrator%E2%80%93comb_filter
+ */
+template <typename AccType>
+class CascadedIntegratorComb
+{
+public:
+    CascadedIntegratorComb(void):
+        N(0),
+        D(0),
+        pos(0)
+    {
+        return;
+    }
+
+    //! Resize initializes and resets the state.
+    void resize(const size_t order, const size_t delay)
+    {
+        N = order;
+        D = delay;
+        pos = 0;
+        integ.assign(N, AccType(0));
+        hist.assign(N*D, AccType(0));
+    }
+
+    /*!
+     * Integrate a block of high rate samples in-place.
+     * Each stage runs over the whole block so that its
+     * accumulator stays in a register rather than in memory.
+     */
+    void integrate(AccType *x, const size_t n)
+    {
+        for (size_t i = 0; i < N; i++)
+        {
+            auto acc = integ[i];
+            for (size_t j = 0; j < n; j++)
+            {
+                acc = cicAdd(acc, x[j]);
+                x[j] = acc;
+            }
+            integ[i] = acc;
+        }
+    }
+
+    //! Feed one low rate sample through the combs.
+    AccType comb(AccType x)
+    {
+        for (size_t i = 0; i < N; i++)
+        {
+            auto &delayed = hist[i*D+pos];
+            const auto y = cicSub(x, delayed);
+            delayed = x;
+            x = y;
+        }
+        if (++pos == D) pos = 0;
+        return x;
+    }
+
+private:
+    size_t N;
+    size_t D;
+    size_t pos;
+    std::vector<AccType> integ;
+    std::vector<AccType> hist;
+};
@@ -1,6 +1,8 @@
 // Copyright (c) 2014-2015 Josh Blum
 // SPDX-License-Identifier: BSL-1.0
 
+#include "FIRKernels.hpp"
+#include "OverlapSave.hpp"
 #include <Pothos/Framework.hpp>
 #include <Pothos/Util/QFormat.hpp>
 #include <cstdint>
@@ -9,10 +11,22 @@
 #include <cstring> //memset, memcpy
 #include <iostream>
 #include <algorithm> //min/max
+#include <memory>
+#include <atomic>
+#include <type_traits>
 
 using Pothos::Util::fromQ;
 using Pothos::Util::floatToQ;
 
+//the automatic mode uses FFT convolution at this many taps per decimation
+static const size_t FFT_CONV_MIN_TAPS = 32;
+
+//the FFT size is a power of two at least this many times the number of taps
+static const size_t FFT_CONV_SIZE_FACTOR = 2;
+
+//the automatic mode uses sparse taps when at most one in this many taps is non-zero
+static const size_t SPARSE_CONV_MIN_RATIO = 8;
+
 /***********************************************************************
  * |PothosDoc FIR Filter
  *
@@ -36,12 +50,57 @@ using Pothos::Util::floatToQ;
  * The end of the burst index is considered to be label.index + label.width - 1.</li>
  * </ol>
  *
+ * <h2>Changing taps</h2>
+ *
+ * New taps are prepared by the caller of setTaps() and handed to the
+ * processing thread with an atomic pointer swap at the start of work(),
+ * so retuning never blocks or modifies the filter that is currently running.
+ * The optional crossfade ramps the output linearly from the old filter
+ * to the new filter over the given number of output elements.
+ * Crossfading applies when the new taps have the same length,
+ * decimation, and interpolation; otherwise the new taps take effect immediately.
+ *
+ * <h2>FFT convolution</h2>
+ *
+ * Long filters can be computed with the overlap-save method,
+ * which convolves blocks of input by multiplication in the frequency domain.
+ * The cost per output grows with the log of the number of taps rather than linearly.
+ * FFT convolution is available for floating point data types without interpolation.
+ * Decimation is supported, although every output is computed before decimation.
+ *
+ * <a href="https://en.wikipedia.org/wiki/Overlap%E2%80%93save_method">
+ * https://en.wikipedia.org/wiki/Overlap%E2%80%93save_method</a>
+ *
+ * <h2>Sparse taps</h2>
+ *
+ * Filters with mostly zero taps, such as multipath channel models,
+ * can be computed with sparse convolution, which stores the delay and value
+ * of each non-zero tap and only multiplies the input at those delays.
+ * The cost per output grows with the number of non-zero taps rather than the filter length.
+ * Sparse convolution supports every data type, decimation, interpolation, and bursts.
+ *
+ * <h2>Real input with complex taps</h2>
+ *
+ * Complex taps with a real data type produce the complex form of the data type on the output.
+ * Each real input element is multiplied by the real and imaginary parts of the taps,
+ * which takes half of the multiplies of widening the input to complex first.
+ * Use this mode for a Hilbert transform or a complex band pass filter
+ * that converts a real signal to an analytic signal, optionally with decimation.
+ *
+ * <h2>Vector data types</h2>
+ *
+ * When the data type has a dimension greater than 1, each lane of the vector element
+ * is filtered as a separate channel with the same taps, decimation, and interpolation.
+ * The dot product runs across the lanes of each element with one tap at a time,
+ * which vectorizes for any number of lanes. Vector data types use the direct method.
+ *
  * |category /Filter
  * |keywords fir filter taps highpass lowpass bandpass
  * |alias /blocks/fir_filter
  *
  * |param dtype[Data Type] The data type of the input and output element stream.
- * |widget DTypeChooser(float=1,cfloat=1,int=1,cint=1)
+ * The output is complex for a real data type with complex taps.
+ * |widget DTypeChooser(float=1,cfloat=1,int=1,cint=1,dim=1)
  * |default "complex_float32"
  * |preview disable
  *
@@ -69,6 +128,24 @@ using Pothos::Util::floatToQ;
  * |option [Enabled] true
  * |option [Disabled] false
  *
+ * |param convolution[Convolution] The convolution method.
+ * The automatic mode selects sparse convolution when most of the taps are zero,
+ * otherwise FFT convolution when the number of taps per decimation is large.
+ * FFT convolution is not used for fixed point data types and interpolation.
+ * |default "AUTO"
+ * |option [Automatic] "AUTO"
+ * |option [Direct] "DIRECT"
+ * |option [FFT] "FFT"
+ * |option [Sparse] "SPARSE"
+ * |preview valid
+ *
+ * |param crossfade[Crossfade] The number of output elements to crossfade over when the taps change.
+ * A value of 0 switches to the new taps immediately.
+ * |units elements
+ * |default 0
+ * |widget SpinBox(minimum=0)
+ * |preview valid
+ *
  * |param frameStartId[Frame Start ID] The label ID to mark the first element of a burst.
  * When the start frame ID is specified and the start frame label contains an element length,
  * the FIR filter will flush out the remainder of the burst without consuming the next burst.
@@ -92,24 +169,58 @@ using Pothos::Util::floatToQ;
  * |setter setDecimation(decim)
  * |setter setInterpolation(interp)
  * |setter setWaitTaps(waitTaps)
+ * |setter setConvolution(convolution)
+ * |setter setCrossfade(crossfade)
  * |setter setFrameStartId(frameStartId)
  * |setter setFrameEndId(frameEndId)
  **********************************************************************/
 template <typename InType, typename OutType, typename TapsType, typename QType, typename QTapsType>
 class FIRFilter : public Pothos::Block
 {
+    //the floating point type for FFT convolution (unused for fixed point)
+    typedef typename FIRScalar<QType>::type QScalar;
+    static const bool FFT_CONV_SUPPORTED = std::is_floating_point<QScalar>::value;
+    typedef std::complex<typename std::conditional<FFT_CONV_SUPPORTED, QScalar, double>::type> FFTType;
+
+    //dot product kernels and their packed taps layout
+    typedef FIRKernels<QType, QTapsType, InType> Kernels;
+    typedef typename Kernels::TapsScalar TapsScalar;
+
+    //! Everything work() needs for one configuration of the filter:
+    //! built by the setters and handed to work() through an atomic pointer
+    struct FilterState
+    {
+        size_t M, L, K, inputRequire;
+        FIRTapsMatrix<TapsScalar> interpTaps;
+        std::vector<typename Kernels::DotFcn> dot;
+        FIRTapsMatrix<QTapsType> laneTaps; //unpacked taps for vector types
+        typename Kernels::LanesFcn lanes;
+        bool sparse;
+        std::vector<size_t> sparseStart; //phase j uses [sparseStart[j], sparseStart[j+1])
+        std::vector<size_t> sparseIndex; //input index in the time-reversed window
+        std::vector<QTapsType> sparseTaps;
+        std::unique_ptr<OverlapSave<FFTType>> fastConv;
+        size_t fastConvMinIn;
+    };
+
 public:
-    FIRFilter(void):
+    FIRFilter(const size_t dimension):
+        _dimension(dimension),
         M(1),
         L(1),
-        K(1),
-        _inputRequire(1),
+        _convolution("AUTO"),
+        _nextState(nullptr),
+        _crossfade(0),
+        _fadeLength(0),
+        _fadeLeft(0),
         _waitTapsMode(false),
         _waitTapsArmed(false),
-        _eobSampsLeft(0)
+        _eobSampsLeft(0),
+        _lanes(dimension),
+        _fadeLanes(dimension)
     {
-        this->setupInput(0, typeid(InType));
-        this->setupOutput(0, typeid(OutType));
+        this->setupInput(0, Pothos::DType(typeid(InType), dimension));
+        this->setupOutput(0, Pothos::DType(typeid(OutType), dimension));
         this->registerCall(this, POTHOS_FCN_TUPLE(FIRFilter, setTaps));
         this->registerCall(this, POTHOS_FCN_TUPLE(FIRFilter, getTaps));
         this->registerCall(this, POTHOS_FCN_TUPLE(FIRFilter, setDecimation));
@@ -118,11 +229,21 @@ public:
         this->registerCall(this, POTHOS_FCN_TUPLE(FIRFilter, getInterpolation));
         this->registerCall(this, POTHOS_FCN_TUPLE(FIRFilter, setWaitTaps));
         this->registerCall(this, POTHOS_FCN_TUPLE(FIRFilter, getWaitTaps));
+        this->registerCall(this, POTHOS_FCN_TUPLE(FIRFilter, setConvolution));
+        this->registerCall(this, POTHOS_FCN_TUPLE(FIRFilter, getConvolution));
+        this->registerCall(this, POTHOS_FCN_TUPLE(FIRFilter, setCrossfade));
+        this->registerCall(this, POTHOS_FCN_TUPLE(FIRFilter, getCrossfade));
         this->registerCall(this, POTHOS_FCN_TUPLE(FIRFilter, setFrameStartId));
         this->registerCall(this, POTHOS_FCN_TUPLE(FIRFilter, getFrameStartId));
         this->registerCall(this, POTHOS_FCN_TUPLE(FIRFilter, setFrameEndId));
         this->registerCall(this, POTHOS_FCN_TUPLE(FIRFilter, getFrameEndId));
         this->setTaps(std::vector<TapsType>(1, TapsType(1))); //initial update
+        _state.reset(_nextState.exchange(nullptr));
+    }
+
+    ~FIRFilter(void)
+    {
+        delete _nextState.exchange(nullptr);
     }
 
     void setWaitTaps(const bool waitTaps)
@@ -172,6 +293,32 @@ public:
         return L;
     }
 
+    void setConvolution(const std::string &convolution)
+    {
+        if (convolution == "AUTO"){}
+        else if (convolution == "DIRECT"){}
+        else if (convolution == "FFT"){}
+        else if (convolution == "SPARSE"){}
+        else throw Pothos::InvalidArgumentException("FIRFilter::setConvolution()", "unknown convolution: " + convolution);
+        _convolution = convolution;
+        this->updateInternals();
+    }
+
+    std::string getConvolution(void) const
+    {
+        return _convolution;
+    }
+
+    void setCrossfade(const size_t crossfade)
+    {
+        _crossfade = crossfade;
+    }
+
+    size_t getCrossfade(void) const
+    {
+        return _crossfade;
+    }
+
     void setFrameStartId(std::string id)
     {
         _frameStartId = id;
@@ -207,6 +354,12 @@ public:
     void work(void)
     {
         if (_waitTapsArmed) return;
+        this->swapState();
+
+        //the active configuration: the members M and L describe the setters,
+        //which may have published a state that is taken on the next call
+        const auto &s = *_state;
+        const size_t M = s.M, L = s.L, K = s.K, D = _dimension;
         auto inPort = this->input(0);
         auto outPort = this->output(0);
         auto inputAvailable = inPort->elements();
@@ -248,9 +401,9 @@ public:
         }
 
         //otherwise insufficient input for the regular streaming mode
-        else if (inputAvailable < _inputRequire)
+        else if (inputAvailable < s.inputRequire)
         {
-            inPort->setReserve(_inputRequire);
+            inPort->setReserve(s.inputRequire);
             return;
         }
 
@@ -261,14 +414,17 @@ public:
          * Special input buffer to flush the burst
          **************************************************************/
         auto inBuff = inPort->buffer();
-        inBuff.length = inputAvailable*sizeof(InType);
-        if (_eobSampsLeft != 0 and _eobSampsLeft < _inputRequire)
+        inBuff.length = inputAvailable*inPort->dtype().size();
+        const bool flush = _eobSampsLeft != 0 and _eobSampsLeft < s.inputRequire;
+        if (flush)
         {
-            const size_t numBytesCopy = _eobSampsLeft*sizeof(InType);
-            Pothos::BufferChunk flushBuff(typeid(InType), _eobSampsLeft + K - 1);
-            std::memcpy(flushBuff.as<void *>(), inBuff.template as<const void *>(), numBytesCopy);
-            std::memset(flushBuff.as<char *>() + numBytesCopy, 0, flushBuff.length-numBytesCopy);
-            inBuff = flushBuff;
+            //the end of the burst followed by K-1 zeros in the scratch buffer
+            const size_t numBytesCopy = _eobSampsLeft*inPort->dtype().size();
+            const size_t numBytesZero = (K-1)*inPort->dtype().size();
+            std::memcpy(_flushBuff.as<void *>(), inBuff.template as<const void *>(), numBytesCopy);
+            std::memset(_flushBuff.as<char *>() + numBytesCopy, 0, numBytesZero);
+            inBuff = _flushBuff;
+            inBuff.length = numBytesCopy + numBytesZero;
         }
 
         /***************************************************************
@@ -277,40 +433,75 @@ public:
         //how many iterations?
         const auto N = std::min((inBuff.elements()-(K-1))/M, outPort->elements()/L)*M;
 
-        //grab pointers
-        auto x = inBuff.template as<const InType *>() + (K-1);
+        //grab pointers, vector types index D scalars per element
+        auto x = inBuff.template as<const InType *>() + (K-1)*D;
         OutType *y = outPort->buffer();
-        size_t decim = M;
 
-        //for each input
-        for (size_t n = 0; n < N; n++)
+        //FFT convolution over the input in blocks (multiples of M),
+        //the direct loop below handles a remainder too short for a transform
+        //and computes both filters while crossfading
+        size_t n = 0;
+        if (s.fastConv and _fadeLeft == 0)
         {
-            //interpolation loop
-            for (size_t j = 0; j < L; j++)
+            const size_t blockSize = (s.fastConv->blockSize()/M)*M;
+            while (N-n >= s.fastConvMinIn)
             {
-                if (--decim != 0) continue;
-                decim = M;
+                const size_t numIn = std::min(blockSize, ((N-n)/M)*M);
+                s.fastConv->filter(x+n-(K-1), numIn, y, M);
+                y += numIn/M;
+                n += numIn;
+            }
+        }
 
-                //convolution loop
-                QType y_n = 0;
-                for (size_t k = 0; k < _interpTaps[j].size(); k++)
+        //for each output: the output at upsampled index u uses phase u%L
+        //with input u/L, and consecutive outputs are M upsampled indexes apart,
+        //so the phase steps by M modulo L and the input by the carry.
+        //This costs one dot product per output rather than a loop over L per input.
+        const size_t numOut = ((N-n)*L)/M;
+        const size_t stepIn = M/L, stepPhase = M%L;
+        size_t i = n + (M-1)/L, j = (M-1)%L;
+        for (size_t m = 0; m < numOut; m++)
+        {
+            //convolution with the time-reversed taps
+            if (D == 1)
+            {
+                QType y_n;
+                dotPhase(s, j, x+i-(K-1), y_n);
+                if (_fadeLeft != 0)
                 {
-                    y_n += _interpTaps[j][k] * QType(x[n-k]);
+                    QType y_old;
+                    dotPhase(*_fadeState, j, x+i-(K-1), y_old);
+                    y_n = mixQ(y_old, y_n, this->fadeWeight());
                 }
                 *y++ = fromQ<OutType>(y_n);
             }
+            else
+            {
+                this->dotLanes(s, j, x+(i-(K-1))*D, y);
+                y += D;
+            }
+            if (_fadeLeft != 0 and --_fadeLeft == 0) _fadeState.reset();
+
+            i += stepIn;
+            j += stepPhase;
+            if (j >= L) {j -= L; i++;}
         }
 
         //consume decimated, produce interpolated
-        //K-1 elements are left in the input buffer for filter history
-        if (_eobSampsLeft != 0) _eobSampsLeft -= N;
-        inPort->consume(N);
+        //K-1 elements are left in the input buffer for filter history,
+        //except at the end of a burst, where the remainder that is
+        //shorter than the decimation produces no output and is dropped
+        size_t numConsume = N;
+        if (flush and _eobSampsLeft-N < M) numConsume = _eobSampsLeft;
+        if (_eobSampsLeft != 0) _eobSampsLeft -= numConsume;
+        inPort->consume(numConsume);
         outPort->produce((N/M)*L);
     }
 
     void propagateLabels(const Pothos::InputPort *port)
     {
         auto outputPort = this->output(0);
+        const size_t M = _state->M, L = _state->L;
         for (const auto &label : port->labels())
         {
             auto newLabel = label.toAdjusted(L, M);
@@ -330,37 +521,172 @@ private:
         assert(M > 0);
         assert(L > 0);
         assert(not _taps.empty());
+        std::unique_ptr<FilterState> state(new FilterState());
+        state->M = M;
+        state->L = L;
 
         //K is the largest value of k for which h[j+kL] is non-zero
-        K = _taps.size()/L + (((_taps.size()%L) == 0)?0:1);
+        const size_t K = _taps.size()/L + (((_taps.size()%L) == 0)?0:1);
         assert(K > 0);
+        state->K = K;
 
         //Precalculate the taps array for each interpolation index,
         //because the zeros contribute nothing to its dot product calculations.
-        _interpTaps.resize(L);
+        //The taps are time-reversed and zero-padded to K taps,
+        //so the dot product kernel walks the input history in order.
+        //All phases share one cache-aligned matrix with a row per phase.
+        //A phase with symmetric or antisymmetric taps uses the folded kernel;
+        //without interpolation that is the whole linear-phase filter,
+        //otherwise only the phases that are symmetric on their own.
+        //Short phases use the kernel compiled for exactly K taps.
+        std::vector<QTapsType> phaseTaps(K);
+        state->interpTaps.resize(L, Kernels::packedSize(K));
+        state->dot.resize(L);
+        if (_dimension > 1) state->laneTaps.resize(L, K);
+        state->lanes = Kernels::lanes(_dimension);
+        size_t maxNonZero = 0;
+        state->sparseStart.assign(1, 0);
         for (size_t j = 0; j < L; j++)
         {
-            _interpTaps[j].clear();
             for (size_t k = 0; k < K; k++)
             {
                 const auto i = j+k*L;
-                if (i >= _taps.size()) continue;
-                _interpTaps[j].push_back(floatToQ<QTapsType>(_taps[i]));
+                phaseTaps[K-1-k] = (i < _taps.size())?floatToQ<QTapsType>(_taps[i]):QTapsType(0);
             }
+            Kernels::pack(phaseTaps.data(), K, state->interpTaps[j]);
+            state->dot[j] = Kernels::dot(K, Kernels::symmetry(phaseTaps.data(), K));
+            if (_dimension > 1) std::copy(phaseTaps.begin(), phaseTaps.end(), state->laneTaps[j]);
+
+            //the non-zero taps of the phase with their index in the window
+            for (size_t k = 0; k < K; k++)
+            {
+                if (phaseTaps[k] == QTapsType(0)) continue;
+                state->sparseIndex.push_back(k);
+                state->sparseTaps.push_back(phaseTaps[k]);
+            }
+            state->sparseStart.push_back(state->sparseIndex.size());
+            maxNonZero = std::max(maxNonZero, state->sparseStart[j+1]-state->sparseStart[j]);
         }
 
+        //sparse convolution when few taps in every phase are non-zero
+        state->sparse = _convolution == "SPARSE" or
+            (_convolution == "AUTO" and maxNonZero*SPARSE_CONV_MIN_RATIO <= K);
+
         //require the minimum number of input elements to produce at least 1 output
-        _inputRequire = (M + (K-1));
+        state->inputRequire = (M + (K-1));
+
+        //FFT convolution with a block size that is a multiple of the decimation
+        state->fastConvMinIn = 0;
+        if (FFT_CONV_SUPPORTED and L == 1 and _dimension == 1 and not state->sparse and _convolution != "DIRECT" and
+            (_convolution == "FFT" or K >= FFT_CONV_MIN_TAPS*M))
+        {
+            size_t fftSize = 1, fftLog2 = 0;
+            while (fftSize < FFT_CONV_SIZE_FACTOR*(K+M)) {fftSize *= 2; fftLog2++;}
+            state->fastConv.reset(new OverlapSave<FFTType>(_taps, fftSize));
+
+            //a partial block is transformed when the direct method would cost more:
+            //about N*log2(N) operations per transform versus K operations per output
+            const size_t minOutputs = (fftSize*fftLog2 + K-1)/K;
+            state->fastConvMinIn = std::min(minOutputs*M, (state->fastConv->blockSize()/M)*M);
+        }
+
+        //publish for the next call to work(), replacing a state that was never used
+        delete _nextState.exchange(state.release());
+    }
+
+    //! Take the newest published state at the start of work(),
+    //! and crossfade from the current state when the structure matches
+    void swapState(void)
+    {
+        std::unique_ptr<FilterState> next(_nextState.exchange(nullptr));
+        if (not next) return;
+        const bool fade = _crossfade != 0 and _state and
+            next->M == _state->M and next->L == _state->L and next->K == _state->K;
+        _fadeState = fade?std::move(_state):nullptr;
+        _fadeLength = fade?_crossfade:0;
+        _fadeLeft = _fadeLength;
+        _state = std::move(next);
+
+        //grow the scratch buffer for the longest burst flush of the new state,
+        //less than inputRequire elements of the burst and K-1 zeros,
+        //so that flushing a burst does not allocate
+        const size_t flushElems = _state->inputRequire + _state->K - 2;
+        if (_flushBuff.elements() < flushElems)
+        {
+            _flushBuff = Pothos::BufferChunk(this->input(0)->dtype(), flushElems);
+        }
+    }
+
+    static void dotPhase(const FilterState &s, const size_t j, const InType *x, QType &y)
+    {
+        if (s.sparse)
+        {
+            const size_t i = s.sparseStart[j], n = s.sparseStart[j+1]-i;
+            Kernels::dotSparse(s.sparseIndex.data()+i, s.sparseTaps.data()+i, n, x, y);
+        }
+        else if (s.dot[j] == nullptr) Kernels::dotScalar(s.interpTaps[j], x, s.K, y);
+        else s.dot[j](s.interpTaps[j], x, s.K, y);
+    }
+
+    static void dotPhaseLanes(const FilterState &s, const size_t j, const InType *x, const size_t D, QType *y)
+    {
+        if (s.sparse)
+        {
+            const size_t i = s.sparseStart[j], n = s.sparseStart[j+1]-i;
+            Kernels::lanesSparse(s.sparseIndex.data()+i, s.sparseTaps.data()+i, n, x, D, y);
+        }
+        else s.lanes(s.laneTaps[j], x, s.K, D, y);
+    }
+
+    //! One output element of D lanes from the lanes of K input elements
+    void dotLanes(const FilterState &s, const size_t j, const InType *x, OutType *y)
+    {
+        const size_t D = _dimension;
+        dotPhaseLanes(s, j, x, D, _lanes.data());
+        if (_fadeLeft != 0)
+        {
+            dotPhaseLanes(*_fadeState, j, x, D, _fadeLanes.data());
+            const double w = this->fadeWeight();
+            for (size_t d = 0; d < D; d++) _lanes[d] = mixQ(_fadeLanes[d], _lanes[d], w);
+        }
+        for (size_t d = 0; d < D; d++) y[d] = fromQ<OutType>(_lanes[d]);
+    }
+
+    //the weight of the new filter for the next output while crossfading
+    double fadeWeight(void) const
+    {
+        return double(_fadeLength-_fadeLeft+1)/(_fadeLength+1);
+    }
+
+    //linear mix a + (b - a)*w in the fixed or floating point Q domain
+    template <typename Type>
+    static Type mixQ(const Type &a, const Type &b, const double w)
+    {
+        return Type(a + (b - a)*w);
+    }
+
+    template <typename Type>
+    static std::complex<Type> mixQ(const std::complex<Type> &a, const std::complex<Type> &b, const double w)
+    {
+        return std::complex<Type>(mixQ(a.real(), b.real(), w), mixQ(a.imag(), b.imag(), w));
     }
 
+    const size_t _dimension;
     std::vector<TapsType> _taps;
-    std::vector<std::vector<QTapsType>> _interpTaps;
-    size_t M, L, K, _inputRequire;
+    size_t M, L;
+    std::string _convolution;
+    std::unique_ptr<FilterState> _state;
+    std::atomic<FilterState *> _nextState;
+    std::unique_ptr<FilterState> _fadeState;
+    size_t _crossfade, _fadeLength, _fadeLeft;
     bool _waitTapsMode;
     bool _waitTapsArmed;
     std::string _frameStartId;
     std::string _frameEndId;
     size_t _eobSampsLeft;
+    Pothos::BufferChunk _flushBuff;
+    std::vector<QType> _lanes;
+    std::vector<QType> _fadeLanes;
 };
 
 /***********************************************************************
@@ -368,12 +694,14 @@ private:
  **********************************************************************/
 static Pothos::Block *FIRFilterFactory(const Pothos::DType &dtype, const std::string &tapsType)
 {
-    #define ifTypeDeclareFactory__(Type, tapsTypeVal, TapsType, QType, QTapsType) \
-        if (dtype == Pothos::DType(typeid(Type)) and tapsType == tapsTypeVal) return new FIRFilter<Type, Type, TapsType, QType, QTapsType>();
+    #define ifTypeDeclareFactory__(InType, OutType, tapsTypeVal, TapsType, QType, QTapsType) \
+        if (Pothos::DType::fromDType(dtype, 1) == Pothos::DType(typeid(InType)) and tapsType == tapsTypeVal) \
+            return new FIRFilter<InType, OutType, TapsType, QType, QTapsType>(dtype.dimension());
     #define ifTypeDeclareFactory(type, qtype) \
-        ifTypeDeclareFactory__(type, "REAL", double, qtype, qtype) \
-        ifTypeDeclareFactory__(std::complex<type>, "REAL", double, std::complex<qtype>, qtype) \
-        ifTypeDeclareFactory__(std::complex<type>, "COMPLEX", std::complex<double>, std::complex<qtype>, std::complex<qtype>)
+        ifTypeDeclareFactory__(type, type, "REAL", double, qtype, qtype) \
+        ifTypeDeclareFactory__(type, std::complex<type>, "COMPLEX", std::complex<double>, std::complex<qtype>, std::complex<qtype>) \
+        ifTypeDeclareFactory__(std::complex<type>, std::complex<type>, "REAL", double, std::complex<qtype>, qtype) \
+        ifTypeDeclareFactory__(std::complex<type>, std::complex<type>, "COMPLEX", std::complex<double>, std::complex<qtype>, std::complex<qtype>)
     ifTypeDeclareFactory(double, double);
     ifTypeDeclareFactory(float, float);
     ifTypeDeclareFactory(int64_t, int64_t);
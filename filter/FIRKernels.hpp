@@ -0,0 +1,994 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#pragma once
+#include <complex>
+#include <cstddef>
+#include <cstring> //memcpy
+#include <cstdint>
+#include <type_traits>
+#include <algorithm> //copy
+#include <vector>
+
+//the scalar type of a real or complex element type
+template <typename Type> struct FIRScalar { typedef Type type; };
+template <typename Type> struct FIRScalar<std::complex<Type>> { typedef Type type; };
+
+/***********************************************************************
+ * SIMD helpers using the GCC/Clang vector extensions:
+ * The same code is compiled for each instruction set below,
+ * and the vector width is a parameter of the kernel templates.
+ **********************************************************************/
+#if defined(__GNUC__)
+#define FIR_KERNELS_SIMD
+#define FIR_INLINE inline __attribute__((always_inline))
+
+template <typename Type, size_t Bytes>
+struct FIRVector
+{
+    typedef Type type __attribute__((vector_size(Bytes)));
+};
+
+//! Unaligned load of a vector, converting the element type when required
+template <typename VecType, typename Type>
+FIR_INLINE void firLoad(VecType &v, const Type *p)
+{
+    typedef typename std::decay<decltype(v[0])>::type ElemType;
+    static const size_t N = sizeof(VecType)/sizeof(ElemType);
+    typename FIRVector<Type, N*sizeof(Type)>::type in;
+    std::memcpy(&in, p, sizeof(in));
+    v = __builtin_convertvector(in, VecType);
+}
+
+//! Load the vector at scalar offset i of the input
+template <typename VecType, typename Type>
+FIR_INLINE void firLoad(VecType &v, const Type *x, const size_t i)
+{
+    firLoad(v, x+i);
+}
+
+//! Get scalar i of the input in the accumulation type
+template <typename SumType, typename Type>
+FIR_INLINE SumType firAt(const Type *x, const size_t i)
+{
+    return SumType(x[i]);
+}
+
+//the signed integer type used as a shuffle index for elements of a given size
+template <size_t Size> struct FIRShuffleIndex;
+template <> struct FIRShuffleIndex<1> { typedef int8_t type; };
+template <> struct FIRShuffleIndex<2> { typedef int16_t type; };
+template <> struct FIRShuffleIndex<4> { typedef int32_t type; };
+template <> struct FIRShuffleIndex<8> { typedef int64_t type; };
+
+template <size_t... I> struct FIRIndexes {};
+template <size_t N, size_t... I> struct FIRMakeIndexes : FIRMakeIndexes<N-1, N-1, I...> {};
+template <size_t... I> struct FIRMakeIndexes<0, I...> { typedef FIRIndexes<I...> type; };
+
+//! Reverse the order of the elements in a vector of E scalars per element
+template <size_t E, typename VecType, size_t... I>
+FIR_INLINE void firReverse(VecType &v, FIRIndexes<I...>)
+{
+    static const size_t N = sizeof...(I);
+    #if defined(__clang__)
+    v = __builtin_shufflevector(v, v, ((N-E)-(I/E)*E+I%E)...);
+    #else
+    typedef typename std::decay<decltype(v[0])>::type ElemType;
+    typedef typename FIRShuffleIndex<sizeof(ElemType)>::type IndexType;
+    typedef typename FIRVector<IndexType, N*sizeof(IndexType)>::type MaskType;
+    const MaskType mask = {IndexType((N-E)-(I/E)*E+I%E)...};
+    v = __builtin_shuffle(v, mask);
+    #endif
+}
+
+/*!
+ * Folded input for symmetric (Sign = 1) or antisymmetric (Sign = -1) taps:
+ * scalar i of the folded input is x[i] plus or minus its mirror image,
+ * the same component of element K-1-k where k is the element of scalar i,
+ * with E scalars per element and end pointing to the scalar after element K-1.
+ * Multiplying the first half of the taps with the folded input
+ * computes the whole dot product with half of the multiplies.
+ */
+template <typename Type, size_t E, int Sign>
+struct FIRFold
+{
+    const Type *x;
+    const Type *end;
+};
+
+template <typename VecType, typename Type, size_t E, int Sign>
+FIR_INLINE void firLoad(VecType &v, const FIRFold<Type, E, Sign> &in, const size_t i)
+{
+    typedef typename std::decay<decltype(v[0])>::type ElemType;
+    static const size_t N = sizeof(VecType)/sizeof(ElemType);
+    VecType fwd, rev;
+    firLoad(fwd, in.x+i);
+    firLoad(rev, in.end-i-N);
+    firReverse<E>(rev, typename FIRMakeIndexes<N>::type());
+    v = (Sign > 0)?(fwd+rev):(fwd-rev);
+}
+
+template <typename SumType, typename Type, size_t E, int Sign>
+FIR_INLINE SumType firAt(const FIRFold<Type, E, Sign> &in, const size_t i)
+{
+    const SumType fwd(in.x[i]), rev(in.end[i%E-E*(i/E+1)]);
+    return (Sign > 0)?(fwd+rev):(fwd-rev);
+}
+
+//! Fold a wide vector into the 128-bit accumulator, preserving lane parity
+template <typename VecType, typename Vec128Type>
+FIR_INLINE void firFold(Vec128Type &acc128, const VecType &acc)
+{
+    Vec128Type parts[sizeof(VecType)/sizeof(Vec128Type)];
+    std::memcpy(parts, &acc, sizeof(acc));
+    for (const auto &part : parts) acc128 += part;
+}
+
+/*!
+ * Multiply and accumulate: acc128[i%N] += a[i]*x[i] over whole vectors.
+ * The bulk of the input uses two interleaved accumulators of the given width,
+ * and the remainder uses 128-bit vectors, so fewer than 16 bytes are left.
+ * The input is a pointer or a folded input view.
+ * Returns the number of scalars processed, all whole 128-bit vectors,
+ * in a form that bounds the caller's remainder loop for a constant len.
+ */
+template <size_t Bytes, typename Vec128Type, typename Type, typename XType>
+FIR_INLINE size_t firMac(Vec128Type &acc128, const Type *a, const XType &x, const size_t len)
+{
+    typedef typename FIRVector<Type, Bytes>::type VecType;
+    static const size_t N = Bytes/sizeof(Type);
+    static const size_t N128 = sizeof(Vec128Type)/sizeof(Type);
+    VecType acc0 = {}, acc1 = {}, a0, a1, x0, x1;
+    size_t i = 0;
+    for (; i+2*N <= len; i += 2*N)
+    {
+        firLoad(a0, a+i);
+        firLoad(a1, a+i+N);
+        firLoad(x0, x, i);
+        firLoad(x1, x, i+N);
+        acc0 += a0*x0;
+        acc1 += a1*x1;
+    }
+    firFold(acc128, acc0+acc1);
+    Vec128Type a128, x128;
+    for (; i+N128 <= len; i += N128)
+    {
+        firLoad(a128, a+i);
+        firLoad(x128, x, i);
+        acc128 += a128*x128;
+    }
+    return len-len%N128;
+}
+
+/*!
+ * Multiply and accumulate two tap arrays against the same input:
+ * accA128[i%N] += a[i]*x[i] and accB128[i%N] += b[i]*x[i].
+ * Returns the number of scalars processed, as for firMac().
+ */
+template <size_t Bytes, typename Vec128Type, typename Type, typename XType>
+FIR_INLINE size_t firMac2(Vec128Type &accA128, Vec128Type &accB128, const Type *a, const Type *b, const XType &x, const size_t len)
+{
+    typedef typename FIRVector<Type, Bytes>::type VecType;
+    static const size_t N = Bytes/sizeof(Type);
+    static const size_t N128 = sizeof(Vec128Type)/sizeof(Type);
+    VecType accA = {}, accB = {}, av, bv, xv;
+    size_t i = 0;
+    for (; i+N <= len; i += N)
+    {
+        firLoad(av, a+i);
+        firLoad(bv, b+i);
+        firLoad(xv, x, i);
+        accA += av*xv;
+        accB += bv*xv;
+    }
+    firFold(accA128, accA);
+    firFold(accB128, accB);
+    Vec128Type a128, b128, x128;
+    for (; i+N128 <= len; i += N128)
+    {
+        firLoad(a128, a+i);
+        firLoad(b128, b+i);
+        firLoad(x128, x, i);
+        accA128 += a128*x128;
+        accB128 += b128*x128;
+    }
+    return len-len%N128;
+}
+
+/*!
+ * Store a complex result with a single vector store,
+ * rather than two scalar stores that would stall a subsequent load.
+ */
+template <typename Type, typename SumType>
+FIR_INLINE void firStore(std::complex<Type> &y, const SumType &re, const SumType &im)
+{
+    const typename FIRVector<Type, 16>::type v = {Type(re), Type(im)};
+    std::memcpy(static_cast<void *>(&y), &v, sizeof(y));
+}
+
+/*!
+ * Sum the even and odd vector lanes (real and imaginary parts)
+ * by adding the upper half of the vector onto the lower half,
+ * until only one pair of lanes is left.
+ */
+template <typename Type, size_t Bytes>
+struct FIRReduce
+{
+    template <typename VecType>
+    static FIR_INLINE void pairs(const VecType &acc, Type &even, Type &odd)
+    {
+        typename FIRVector<Type, Bytes/2>::type lo, hi;
+        std::memcpy(&lo, &acc, sizeof(lo));
+        std::memcpy(&hi, reinterpret_cast<const char *>(&acc)+sizeof(lo), sizeof(hi));
+        FIRReduce<Type, Bytes/2>::pairs(lo+hi, even, odd);
+    }
+};
+
+template <typename Type>
+struct FIRReduce<Type, 2*sizeof(Type)>
+{
+    template <typename VecType>
+    static FIR_INLINE void pairs(const VecType &acc, Type &even, Type &odd)
+    {
+        even += acc[0];
+        odd += acc[1];
+    }
+};
+
+template <typename VecType, typename Type>
+FIR_INLINE void firReduce(const VecType &acc, Type &even, Type &odd)
+{
+    FIRReduce<Type, sizeof(VecType)>::pairs(acc, even, odd);
+}
+#endif //__GNUC__
+
+/***********************************************************************
+ * FIR dot product: y = sum(taps[i]*x[i]) for i in [0, K),
+ * where the taps are time-reversed so that x[0] is the oldest input.
+ *
+ * The taps are packed into a kernel specific layout of scalars,
+ * which turns complex multiplies into element-wise multiplies
+ * against the interleaved input, so the kernels never shuffle.
+ * Complex accumulation order differs from std::complex arithmetic,
+ * so floating point results match the reference within rounding.
+ *
+ * The Sign parameter of the vector kernels selects the folded kernel
+ * for symmetric (1) or antisymmetric (-1) taps, which reads only the
+ * first half of the packed taps, or the direct kernel (0) otherwise.
+ **********************************************************************/
+template <typename QType, typename QTapsType, typename InType>
+struct FIRDot
+{
+    //real taps, real input: layout t[k]
+    typedef QTapsType TapsScalar;
+
+    static size_t packedSize(const size_t K)
+    {
+        return K;
+    }
+
+    static void pack(const QTapsType *taps, const size_t K, TapsScalar *packed)
+    {
+        for (size_t k = 0; k < K; k++) packed[k] = taps[k];
+    }
+
+    static void dotScalar(const TapsScalar *t, const InType *x, const size_t K, QType &y)
+    {
+        y = 0;
+        for (size_t k = 0; k < K; k++) y += t[k]*QType(x[k]);
+    }
+
+    #ifdef FIR_KERNELS_SIMD
+    template <size_t Bytes, typename XType>
+    static FIR_INLINE void mac(const TapsScalar *t, const XType &x, const size_t K, QType &y)
+    {
+        typename FIRVector<QType, 16>::type acc = {};
+        size_t k = firMac<Bytes>(acc, t, x, K);
+        QType even = 0, odd = 0;
+        firReduce(acc, even, odd);
+        for (; k < K; k++) even += t[k]*firAt<QType>(x, k);
+        y = even+odd;
+    }
+
+    template <size_t Bytes, int Sign>
+    static FIR_INLINE void dot(const TapsScalar *t, const InType *x, const size_t K, QType &y)
+    {
+        if (Sign == 0) return mac<Bytes>(t, x, K, y);
+        mac<Bytes>(t, FIRFold<InType, 1, Sign>{x, x+K}, K/2, y);
+        if (Sign > 0 and K%2 == 1) y += t[K/2]*QType(x[K/2]);
+    }
+    #endif //FIR_KERNELS_SIMD
+};
+
+template <typename QScalar, typename InScalar>
+struct FIRDot<std::complex<QScalar>, QScalar, std::complex<InScalar>>
+{
+    //real taps, complex input: layout t[k] duplicated for re and im
+    typedef QScalar TapsScalar;
+    typedef std::complex<QScalar> QType;
+
+    static size_t packedSize(const size_t K)
+    {
+        return 2*K;
+    }
+
+    static void pack(const QScalar *taps, const size_t K, TapsScalar *packed)
+    {
+        for (size_t k = 0; k < K; k++) packed[2*k+0] = packed[2*k+1] = taps[k];
+    }
+
+    static void dotScalar(const TapsScalar *t, const std::complex<InScalar> *x, const size_t K, QType &y)
+    {
+        y = 0;
+        for (size_t k = 0; k < K; k++) y += t[2*k]*QType(x[k]);
+    }
+
+    #ifdef FIR_KERNELS_SIMD
+    template <size_t Bytes, typename XType>
+    static FIR_INLINE void mac(const TapsScalar *t, const XType &x, const size_t K, QType &y)
+    {
+        typename FIRVector<QScalar, 16>::type acc = {};
+        size_t i = firMac<Bytes>(acc, t, x, 2*K);
+        QScalar re = 0, im = 0;
+        firReduce(acc, re, im);
+        for (; i < 2*K; i += 2)
+        {
+            re += t[i+0]*firAt<QScalar>(x, i+0);
+            im += t[i+1]*firAt<QScalar>(x, i+1);
+        }
+        firStore(y, re, im);
+    }
+
+    template <size_t Bytes, int Sign>
+    static FIR_INLINE void dot(const TapsScalar *t, const std::complex<InScalar> *xc, const size_t K, QType &y)
+    {
+        const InScalar *x = reinterpret_cast<const InScalar *>(xc);
+        if (Sign == 0) return mac<Bytes>(t, x, K, y);
+        mac<Bytes>(t, FIRFold<InScalar, 2, Sign>{x, x+2*K}, K/2, y);
+        if (Sign > 0 and K%2 == 1) y += t[2*(K/2)]*QType(xc[K/2]);
+    }
+    #endif //FIR_KERNELS_SIMD
+};
+
+template <typename QScalar, typename InScalar>
+struct FIRDot<std::complex<QScalar>, std::complex<QScalar>, std::complex<InScalar>>
+{
+    //complex taps, complex input: layout [re, re] for all k, then [im, im] for all k
+    typedef QScalar TapsScalar;
+    typedef std::complex<QScalar> QType;
+
+    static size_t packedSize(const size_t K)
+    {
+        return 4*K;
+    }
+
+    static void pack(const QType *taps, const size_t K, TapsScalar *packed)
+    {
+        for (size_t k = 0; k < K; k++)
+        {
+            packed[2*k+0] = packed[2*k+1] = taps[k].real();
+            packed[2*K+2*k+0] = packed[2*K+2*k+1] = taps[k].imag();
+        }
+    }
+
+    static void dotScalar(const TapsScalar *t, const std::complex<InScalar> *x, const size_t K, QType &y)
+    {
+        y = 0;
+        for (size_t k = 0; k < K; k++) y += QType(t[2*k], t[2*K+2*k])*QType(x[k]);
+    }
+
+    #ifdef FIR_KERNELS_SIMD
+    template <size_t Bytes, typename XType>
+    static FIR_INLINE void mac(const TapsScalar *tr, const TapsScalar *ti, const XType &x, const size_t K, QType &y)
+    {
+        //accA holds [tr*xr, tr*xi], accB holds [ti*xr, ti*xi]
+        typename FIRVector<QScalar, 16>::type accA = {}, accB = {};
+        size_t i = firMac2<Bytes>(accA, accB, tr, ti, x, 2*K);
+        QScalar rr = 0, ri = 0, ir = 0, ii = 0;
+        firReduce(accA, rr, ri);
+        firReduce(accB, ir, ii);
+        for (; i < 2*K; i += 2)
+        {
+            const QScalar xr = firAt<QScalar>(x, i+0), xi = firAt<QScalar>(x, i+1);
+            rr += tr[i+0]*xr;
+            ri += tr[i+1]*xi;
+            ir += ti[i+0]*xr;
+            ii += ti[i+1]*xi;
+        }
+        firStore(y, rr-ii, ri+ir);
+    }
+
+    template <size_t Bytes, int Sign>
+    static FIR_INLINE void dot(const TapsScalar *t, const std::complex<InScalar> *xc, const size_t K, QType &y)
+    {
+        const InScalar *x = reinterpret_cast<const InScalar *>(xc);
+        if (Sign == 0) return mac<Bytes>(t, t+2*K, x, K, y);
+        mac<Bytes>(t, t+2*K, FIRFold<InScalar, 2, Sign>{x, x+2*K}, K/2, y);
+        if (Sign > 0 and K%2 == 1) y += QType(t[2*(K/2)], t[2*K+2*(K/2)])*QType(xc[K/2]);
+    }
+    #endif //FIR_KERNELS_SIMD
+};
+
+template <typename QScalar, typename InScalar>
+struct FIRDot<std::complex<QScalar>, std::complex<QScalar>, InScalar>
+{
+    //complex taps, real input: layout re for all k, then im for all k
+    typedef QScalar TapsScalar;
+    typedef std::complex<QScalar> QType;
+
+    static size_t packedSize(const size_t K)
+    {
+        return 2*K;
+    }
+
+    static void pack(const QType *taps, const size_t K, TapsScalar *packed)
+    {
+        for (size_t k = 0; k < K; k++)
+        {
+            packed[k] = taps[k].real();
+            packed[K+k] = taps[k].imag();
+        }
+    }
+
+    static void dotScalar(const TapsScalar *t, const InScalar *x, const size_t K, QType &y)
+    {
+        QScalar re = 0, im = 0;
+        for (size_t k = 0; k < K; k++)
+        {
+            re += t[k]*QScalar(x[k]);
+            im += t[K+k]*QScalar(x[k]);
+        }
+        y = QType(re, im);
+    }
+
+    #ifdef FIR_KERNELS_SIMD
+    template <size_t Bytes, typename XType>
+    static FIR_INLINE void mac(const TapsScalar *tr, const TapsScalar *ti, const XType &x, const size_t K, QType &y)
+    {
+        //both parts of the output share each real input, so the input is never duplicated
+        typename FIRVector<QScalar, 16>::type accRe = {}, accIm = {};
+        size_t k = firMac2<Bytes>(accRe, accIm, tr, ti, x, K);
+        QScalar re0 = 0, re1 = 0, im0 = 0, im1 = 0;
+        firReduce(accRe, re0, re1);
+        firReduce(accIm, im0, im1);
+        for (; k < K; k++)
+        {
+            const QScalar xk = firAt<QScalar>(x, k);
+            re0 += tr[k]*xk;
+            im0 += ti[k]*xk;
+        }
+        firStore(y, re0+re1, im0+im1);
+    }
+
+    template <size_t Bytes, int Sign>
+    static FIR_INLINE void dot(const TapsScalar *t, const InScalar *x, const size_t K, QType &y)
+    {
+        if (Sign == 0) return mac<Bytes>(t, t+K, x, K, y);
+        mac<Bytes>(t, t+K, FIRFold<InScalar, 1, Sign>{x, x+K}, K/2, y);
+        if (Sign > 0 and K%2 == 1) y += QType(t[K/2], t[K+K/2])*QScalar(x[K/2]);
+    }
+    #endif //FIR_KERNELS_SIMD
+};
+
+/***********************************************************************
+ * Sparse FIR dot products visit only the non-zero taps of a filter:
+ * y = sum(taps[i]*x[index[i]]) for i in [0, n).
+ * Complex products are written out, because std::complex multiplication
+ * handles infinities and NaNs with a library call for floating point.
+ **********************************************************************/
+template <typename QType, typename TapType, typename InType>
+inline void firSparseMac(QType &y, const TapType &t, const InType &x)
+{
+    y += t*QType(x);
+}
+
+template <typename QScalar, typename InScalar>
+inline void firSparseMac(std::complex<QScalar> &y, const std::complex<QScalar> &t, const std::complex<InScalar> &x)
+{
+    const QScalar xr(x.real()), xi(x.imag());
+    y = std::complex<QScalar>(y.real() + t.real()*xr - t.imag()*xi, y.imag() + t.real()*xi + t.imag()*xr);
+}
+
+template <typename QScalar, typename InScalar>
+inline void firSparseMac(std::complex<QScalar> &y, const std::complex<QScalar> &t, const InScalar &x)
+{
+    const QScalar xr(x);
+    y = std::complex<QScalar>(y.real() + t.real()*xr, y.imag() + t.imag()*xr);
+}
+
+/***********************************************************************
+ * Multichannel FIR dot products over vector elements:
+ * x holds K frames of D lanes with the oldest frame first,
+ * and every lane is filtered separately with the same time-reversed taps.
+ *
+ * The kernels multiply one tap broadcast across a block of lanes,
+ * so the vectors run along the lanes of each frame without shuffles.
+ * Real taps treat both parts of a complex lane as separate real lanes.
+ * Complex taps accumulate the products with the real and imaginary
+ * parts of the tap separately and combine them once per output,
+ * or interleave them into complex outputs for real input lanes.
+ *
+ * E is the scalars per input lane, T the parts per tap,
+ * O the output scalars per input scalar, and P the input scalars
+ * that combine into one output (complex lanes with complex taps).
+ **********************************************************************/
+template <typename QType, typename QTapsType, typename InType>
+struct FIRLanes
+{
+    //real taps: every scalar of the input is a lane
+    typedef typename FIRScalar<QType>::type SumType;
+    typedef typename FIRScalar<InType>::type Scalar;
+    static const size_t E = sizeof(InType)/sizeof(Scalar);
+    static const size_t T = 1;
+    static const size_t O = 1;
+    static const size_t P = 1;
+
+    static void combine(const SumType *accRe, const SumType *, const size_t S, SumType *y)
+    {
+        std::copy(accRe, accRe+S, y);
+    }
+
+    static void tap(const QTapsType *t, const size_t k, SumType &re, SumType &)
+    {
+        re = SumType(t[k]);
+    }
+
+    static void dotScalar(const QTapsType *t, const InType *x, const size_t K, const size_t D, QType *y)
+    {
+        const size_t S = D*E;
+        auto xs = reinterpret_cast<const Scalar *>(x);
+        auto ys = reinterpret_cast<SumType *>(y);
+        for (size_t s = 0; s < S; s++)
+        {
+            SumType acc = 0;
+            for (size_t k = 0; k < K; k++) acc += SumType(t[k])*SumType(xs[k*S+s]);
+            ys[s] = acc;
+        }
+    }
+};
+
+template <typename QType, typename QTapsType, typename InType>
+struct FIRLanes<std::complex<QType>, std::complex<QTapsType>, std::complex<InType>>
+{
+    //complex taps: scalar lanes in pairs, combined from two accumulators
+    typedef QType SumType;
+    typedef InType Scalar;
+    static const size_t E = 2;
+    static const size_t T = 2;
+    static const size_t O = 1;
+    static const size_t P = 2;
+
+    static void combine(const SumType *accRe, const SumType *accIm, const size_t S, SumType *y)
+    {
+        for (size_t s = 0; s < S; s += 2)
+        {
+            y[s+0] = accRe[s+0] - accIm[s+1];
+            y[s+1] = accRe[s+1] + accIm[s+0];
+        }
+    }
+
+    static void tap(const std::complex<QTapsType> *t, const size_t k, SumType &re, SumType &im)
+    {
+        re = SumType(t[k].real());
+        im = SumType(t[k].imag());
+    }
+
+    static void dotScalar(const std::complex<QTapsType> *t, const std::complex<InType> *x, const size_t K, const size_t D, std::complex<QType> *y)
+    {
+        for (size_t d = 0; d < D; d++)
+        {
+            std::complex<QType> acc(0);
+            for (size_t k = 0; k < K; k++) acc += std::complex<QType>(t[k])*std::complex<QType>(x[k*D+d]);
+            y[d] = acc;
+        }
+    }
+};
+
+template <typename QType, typename QTapsType, typename InType>
+struct FIRLanes<std::complex<QType>, std::complex<QTapsType>, InType>
+{
+    //complex taps, real input: each real lane makes a complex output lane
+    typedef QType SumType;
+    typedef InType Scalar;
+    static const size_t E = 1;
+    static const size_t T = 2;
+    static const size_t O = 2;
+    static const size_t P = 1;
+
+    static void combine(const SumType *accRe, const SumType *accIm, const size_t S, SumType *y)
+    {
+        for (size_t s = 0; s < S; s++)
+        {
+            y[2*s+0] = accRe[s];
+            y[2*s+1] = accIm[s];
+        }
+    }
+
+    static void tap(const std::complex<QTapsType> *t, const size_t k, SumType &re, SumType &im)
+    {
+        re = SumType(t[k].real());
+        im = SumType(t[k].imag());
+    }
+
+    static void dotScalar(const std::complex<QTapsType> *t, const InType *x, const size_t K, const size_t D, std::complex<QType> *y)
+    {
+        for (size_t d = 0; d < D; d++)
+        {
+            std::complex<QType> acc(0);
+            for (size_t k = 0; k < K; k++) acc += std::complex<QType>(t[k])*QType(x[k*D+d]);
+            y[d] = acc;
+        }
+    }
+};
+
+#ifdef FIR_KERNELS_SIMD
+//! Multiply and accumulate one vector of lanes with tap k: accRe += re(tap)*x, accIm += im(tap)*x
+template <typename Lanes, typename VecType, typename TapsType>
+FIR_INLINE void firLaneMac(VecType &accRe, VecType &accIm, const TapsType *t, const size_t k, const typename Lanes::Scalar *x)
+{
+    typename Lanes::SumType tr = 0, ti = 0;
+    Lanes::tap(t, k, tr, ti);
+    VecType xv;
+    firLoad(xv, x);
+    accRe += (VecType{} + tr)*xv;
+    if (Lanes::T == 2) accIm += (VecType{} + ti)*xv;
+}
+
+//! Accumulator I = c*NV+v takes tap k+c and vector v of the lanes in that input frame
+template <typename Lanes, size_t NV, typename VecType, typename TapsType, size_t... I>
+FIR_INLINE void firLaneMacs(VecType *accRe, VecType *accIm, const TapsType *t, const size_t k, const typename Lanes::Scalar *x, const size_t S, FIRIndexes<I...>)
+{
+    static const size_t N = sizeof(VecType)/sizeof(typename Lanes::SumType);
+    const int expand[] = {(firLaneMac<Lanes>(accRe[I], accIm[I], t, k+I/NV, x+(k+I/NV)*S+(I%NV)*N), 0)...};
+    (void)expand;
+}
+
+//! Sum the accumulators of the interleaved taps into the first NV accumulators
+template <size_t NV, typename VecType, size_t... I>
+FIR_INLINE void firLaneSum(VecType *accRe, VecType *accIm, FIRIndexes<I...>)
+{
+    const int expand[] = {0, (accRe[I%NV] += accRe[NV+I], accIm[I%NV] += accIm[NV+I], 0)...};
+    (void)expand; (void)accRe; (void)accIm; //no other taps to sum with a single set
+}
+
+/*!
+ * Accumulate a block of NV vectors of lanes over all K taps,
+ * with S scalars per input frame, then store the block of outputs.
+ * Narrow blocks interleave consecutive taps over C sets of accumulators,
+ * so that the multiply-adds do not wait on a single dependency chain.
+ * The accumulators are unrolled by index so that they stay in registers.
+ */
+template <typename Lanes, size_t NV, typename VecType, typename TapsType>
+FIR_INLINE void firLaneBlock(const TapsType *t, const typename Lanes::Scalar *x, const size_t K, const size_t S, typename Lanes::SumType *y)
+{
+    typedef typename Lanes::SumType SumType;
+    static const size_t N = sizeof(VecType)/sizeof(SumType);
+    static const size_t C = (NV < 4)?(4/NV):1;
+    VecType accRe[C*NV] = {}, accIm[C*NV] = {};
+    size_t k = 0;
+    for (; k+C <= K; k += C) firLaneMacs<Lanes, NV>(accRe, accIm, t, k, x, S, typename FIRMakeIndexes<C*NV>::type());
+    for (; k < K; k++) firLaneMacs<Lanes, NV>(accRe, accIm, t, k, x, S, typename FIRMakeIndexes<NV>::type());
+    firLaneSum<NV>(accRe, accIm, typename FIRMakeIndexes<(C-1)*NV>::type());
+    SumType re[NV*N], im[NV*N];
+    std::memcpy(re, accRe, sizeof(re));
+    std::memcpy(im, accIm, sizeof(im));
+    Lanes::combine(re, im, NV*N, y);
+}
+
+/*!
+ * The lanes of a frame in blocks of four vectors of the given width,
+ * then two and single vectors, then 128-bit vectors, and pairs of scalars at the end
+ * (lanes that combine in pairs are always pairs, an odd number of other lanes ends with one).
+ */
+template <size_t Bytes, typename Lanes, typename TapsType, typename InType, typename QType>
+FIR_INLINE void firLanes(const TapsType *t, const InType *x, const size_t K, const size_t D, QType *y)
+{
+    typedef typename Lanes::SumType SumType;
+    typedef typename FIRVector<SumType, Bytes>::type VecType;
+    typedef typename FIRVector<SumType, 16>::type Vec128Type;
+    typedef typename FIRVector<SumType, 2*sizeof(SumType)>::type Vec2Type;
+    typedef typename FIRVector<SumType, sizeof(SumType)>::type Vec1Type;
+    static const size_t N = Bytes/sizeof(SumType);
+    static const size_t N128 = 16/sizeof(SumType);
+    const size_t S = D*Lanes::E;
+    auto xs = reinterpret_cast<const typename Lanes::Scalar *>(x);
+    auto ys = reinterpret_cast<SumType *>(y);
+    size_t s = 0;
+    static const size_t O = Lanes::O;
+    for (; s+4*N <= S; s += 4*N) firLaneBlock<Lanes, 4, VecType>(t, xs+s, K, S, ys+s*O);
+    for (; s+2*N <= S; s += 2*N) firLaneBlock<Lanes, 2, VecType>(t, xs+s, K, S, ys+s*O);
+    for (; s+N <= S; s += N) firLaneBlock<Lanes, 1, VecType>(t, xs+s, K, S, ys+s*O);
+    for (; s+N128 <= S; s += N128) firLaneBlock<Lanes, 1, Vec128Type>(t, xs+s, K, S, ys+s*O);
+    for (; s+2 <= S; s += 2) firLaneBlock<Lanes, 1, Vec2Type>(t, xs+s, K, S, ys+s*O);
+    for (; Lanes::P == 1 and s < S; s++) firLaneBlock<Lanes, 1, Vec1Type>(t, xs+s, K, S, ys+s*O);
+}
+#endif //FIR_KERNELS_SIMD
+
+/***********************************************************************
+ * Runtime dispatch of the dot product across instruction sets:
+ * Each kernel instantiates the same template with a target attribute
+ * and the vector width of that instruction set.
+ * The CPUID feature flags are checked once, and the widest kernel
+ * that the packed taps fill is selected for each filter length.
+ * Short filters use kernels unrolled for their exact number of taps,
+ * selected from a table per instruction set, so the loop bounds
+ * and remainders are resolved at compile time.
+ * Symmetric taps use the folded kernel when half of the taps is long
+ * enough to amortize reversing the mirrored input in each vector.
+ **********************************************************************/
+static const size_t FIR_KERNELS_MIN_BYTES = 64;
+
+//the 512-bit kernel has a larger fixed cost and pays off on long filters
+static const size_t FIR_KERNELS_AVX512_MIN_BYTES = 1024;
+
+//the folded kernel pays off when the half of the taps that it reads is this long
+static const size_t FIR_KERNELS_FOLD_MIN_BYTES = 512;
+
+//filters up to this many taps use the kernels for a compile-time number of taps
+static const size_t FIR_KERNELS_FIXED_MAX_TAPS = 32;
+
+#if defined(FIR_KERNELS_SIMD) && (defined(__x86_64__) || defined(__i386__))
+#define FIR_KERNELS_X86
+#endif
+
+template <typename QType, typename QTapsType, typename InType>
+struct FIRKernels
+{
+    typedef FIRDot<QType, QTapsType, InType> Dot;
+    typedef typename Dot::TapsScalar TapsScalar;
+    typedef void (*DotFcn)(const TapsScalar *, const InType *, const size_t, QType &);
+    typedef FIRLanes<QType, QTapsType, InType> Lanes;
+    typedef void (*LanesFcn)(const QTapsType *, const InType *, const size_t, const size_t, QType *);
+
+    //! The number of packed tap scalars for K taps
+    static size_t packedSize(const size_t K)
+    {
+        return Dot::packedSize(K);
+    }
+
+    //! Pack K time-reversed taps into the layout used by the kernels
+    static void pack(const QTapsType *taps, const size_t K, TapsScalar *packed)
+    {
+        Dot::pack(taps, K, packed);
+    }
+
+    //! Sequential accumulation, the reference for other kernels
+    static void dotScalar(const TapsScalar *taps, const InType *x, const size_t K, QType &y)
+    {
+        Dot::dotScalar(taps, x, K, y);
+    }
+
+    //! Sequential accumulation of D lanes with unpacked time-reversed taps
+    static void lanesScalar(const QTapsType *taps, const InType *x, const size_t K, const size_t D, QType *y)
+    {
+        Lanes::dotScalar(taps, x, K, D, y);
+    }
+
+    #ifdef FIR_KERNELS_SIMD
+    //! Portable 128-bit vectors (SSE2 on x86, NEON or similar elsewhere)
+    template <int Sign>
+    static void dotVec128(const TapsScalar *taps, const InType *x, const size_t K, QType &y)
+    {
+        Dot::template dot<16, Sign>(taps, x, K, y);
+    }
+
+    static void lanesVec128(const QTapsType *taps, const InType *x, const size_t K, const size_t D, QType *y)
+    {
+        firLanes<16, Lanes>(taps, x, K, D, y);
+    }
+
+    //! The kernels for a fixed number of taps N ignore the K argument
+    template <size_t N>
+    static void dotFixedVec128(const TapsScalar *taps, const InType *x, const size_t, QType &y)
+    {
+        Dot::template dot<16, 0>(taps, x, N, y);
+    }
+    #endif //FIR_KERNELS_SIMD
+
+    #ifdef FIR_KERNELS_X86
+    template <int Sign>
+    __attribute__((target("avx2,fma")))
+    static void dotAVX2(const TapsScalar *taps, const InType *x, const size_t K, QType &y)
+    {
+        Dot::template dot<32, Sign>(taps, x, K, y);
+    }
+
+    template <int Sign>
+    __attribute__((target("avx512f")))
+    static void dotAVX512(const TapsScalar *taps, const InType *x, const size_t K, QType &y)
+    {
+        Dot::template dot<64, Sign>(taps, x, K, y);
+    }
+
+    template <size_t N>
+    __attribute__((target("avx2,fma")))
+    static void dotFixedAVX2(const TapsScalar *taps, const InType *x, const size_t, QType &y)
+    {
+        Dot::template dot<32, 0>(taps, x, N, y);
+    }
+
+    __attribute__((target("avx2,fma")))
+    static void lanesAVX2(const QTapsType *taps, const InType *x, const size_t K, const size_t D, QType *y)
+    {
+        firLanes<32, Lanes>(taps, x, K, D, y);
+    }
+
+    __attribute__((target("avx512f")))
+    static void lanesAVX512(const QTapsType *taps, const InType *x, const size_t K, const size_t D, QType *y)
+    {
+        firLanes<64, Lanes>(taps, x, K, D, y);
+    }
+    #endif //FIR_KERNELS_X86
+
+    //! Sparse dot product over the n non-zero taps at the given input indexes
+    static void dotSparse(const size_t *index, const QTapsType *taps, const size_t n, const InType *x, QType &y)
+    {
+        y = QType(0);
+        for (size_t i = 0; i < n; i++) firSparseMac(y, taps[i], x[index[i]]);
+    }
+
+    //! Sparse dot product of D lanes, where input frame k starts at x[k*D]
+    static void lanesSparse(const size_t *index, const QTapsType *taps, const size_t n, const InType *x, const size_t D, QType *y)
+    {
+        for (size_t d = 0; d < D; d++) y[d] = QType(0);
+        for (size_t i = 0; i < n; i++)
+        {
+            const InType *xi = x + index[i]*D;
+            for (size_t d = 0; d < D; d++) firSparseMac(y[d], taps[i], xi[d]);
+        }
+    }
+
+    //! Get the fastest dot product supported by this CPU for K taps,
+    //! or nullptr when the scalar loop should be used instead.
+    //! The symmetry is 1 for symmetric taps, -1 for antisymmetric taps, or 0.
+    static DotFcn dot(const size_t K, const int symmetry = 0)
+    {
+        #ifdef FIR_KERNELS_SIMD
+        if (K <= FIR_KERNELS_FIXED_MAX_TAPS) return fixed(K, typename FIRMakeIndexes<FIR_KERNELS_FIXED_MAX_TAPS+1>::type());
+        #endif //FIR_KERNELS_SIMD
+        const bool fold = packedSize(K/2)*sizeof(TapsScalar) >= FIR_KERNELS_FOLD_MIN_BYTES;
+        if (fold and symmetry > 0) return select<1>(K/2);
+        if (fold and symmetry < 0) return select<-1>(K/2);
+        return select<0>(K);
+    }
+
+    //! Get the fastest multichannel dot product supported by this CPU for D lanes,
+    //! the widest vectors that the lanes of one input element fill
+    static LanesFcn lanes(const size_t D)
+    {
+        #ifdef FIR_KERNELS_X86
+        const size_t bytes = D*Lanes::E*sizeof(typename Lanes::SumType);
+        static const size_t width = vectorWidth();
+        if (width >= 64 and bytes >= 64) return &lanesAVX512;
+        if (width >= 32 and bytes >= 32) return &lanesAVX2;
+        #endif //FIR_KERNELS_X86
+        #ifdef FIR_KERNELS_SIMD
+        return &lanesVec128;
+        #else
+        return &lanesScalar;
+        #endif //FIR_KERNELS_SIMD
+    }
+
+    //! Get the symmetry of K time-reversed taps for dot()
+    static int symmetry(const QTapsType *taps, const size_t K)
+    {
+        bool even = true, odd = true;
+        for (size_t k = 0; k < K/2; k++)
+        {
+            even = even and taps[k] == taps[K-1-k];
+            odd = odd and taps[k] == -taps[K-1-k];
+        }
+        if (K%2 == 1) odd = odd and taps[K/2] == QTapsType(0);
+        return even?1:(odd?-1:0);
+    }
+
+private:
+    //select the kernel by the number of taps that it reads
+    template <int Sign>
+    static DotFcn select(const size_t numRead)
+    {
+        const size_t bytes = packedSize(numRead)*sizeof(TapsScalar);
+        if (bytes < FIR_KERNELS_MIN_BYTES) return nullptr;
+        #ifdef FIR_KERNELS_X86
+        static const size_t width = vectorWidth();
+        if (width >= 64 and bytes >= FIR_KERNELS_AVX512_MIN_BYTES) return &dotAVX512<Sign>;
+        if (width >= 32) return &dotAVX2<Sign>;
+        #endif //FIR_KERNELS_X86
+        #ifdef FIR_KERNELS_SIMD
+        return &dotVec128<Sign>;
+        #else
+        return nullptr;
+        #endif //FIR_KERNELS_SIMD
+    }
+
+    #ifdef FIR_KERNELS_SIMD
+    //select the kernel for exactly K taps from the tables indexed by K
+    template <size_t... N>
+    static DotFcn fixed(const size_t K, FIRIndexes<N...>)
+    {
+        #ifdef FIR_KERNELS_X86
+        static const DotFcn avx2[] = {&dotFixedAVX2<N>...};
+        static const size_t width = vectorWidth();
+        if (width >= 32) return avx2[K];
+        #endif //FIR_KERNELS_X86
+        static const DotFcn vec128[] = {&dotFixedVec128<N>...};
+        return vec128[K];
+    }
+    #endif //FIR_KERNELS_SIMD
+
+    #ifdef FIR_KERNELS_X86
+    static size_t vectorWidth(void)
+    {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) return 64;
+        if (__builtin_cpu_supports("avx2") and __builtin_cpu_supports("fma")) return 32;
+        return 16;
+    }
+    #endif //FIR_KERNELS_X86
+};
+
+/***********************************************************************
+ * Polyphase taps matrix: one row of packed taps per phase,
+ * stored contiguously with each row aligned to a cache line,
+ * so a phase never shares a line with its neighbours and the
+ * kernels walk the whole bank without chasing separate allocations.
+ **********************************************************************/
+static const size_t FIR_KERNELS_ALIGN = 64;
+
+template <typename Type>
+class FIRTapsMatrix
+{
+public:
+    FIRTapsMatrix(void):
+        _data(nullptr),
+        _rows(0),
+        _stride(0)
+    {
+        return;
+    }
+
+    //! Copies are aligned again for their own storage
+    FIRTapsMatrix(const FIRTapsMatrix &other):
+        _data(nullptr),
+        _rows(0),
+        _stride(0)
+    {
+        *this = other;
+    }
+
+    FIRTapsMatrix &operator=(const FIRTapsMatrix &other)
+    {
+        if (this == &other) return *this;
+        this->resize(other._rows, other._stride);
+        std::copy(other[0], other[0]+other._rows*other._stride, (*this)[0]);
+        return *this;
+    }
+
+    //! Resize to the given rows of at least cols elements, zero filled
+    void resize(const size_t rows, const size_t cols)
+    {
+        static_assert(FIR_KERNELS_ALIGN % sizeof(Type) == 0, "element must divide cache line");
+        const size_t lineElems = FIR_KERNELS_ALIGN/sizeof(Type);
+        _rows = rows;
+        _stride = ((cols + lineElems - 1)/lineElems)*lineElems;
+        _storage.assign(rows*_stride + lineElems, Type(0));
+        const auto addr = reinterpret_cast<uintptr_t>(_storage.data());
+        const size_t offset = ((FIR_KERNELS_ALIGN - addr%FIR_KERNELS_ALIGN)%FIR_KERNELS_ALIGN)/sizeof(Type);
+        _data = _storage.data() + offset;
+    }
+
+    Type *operator[](const size_t row)
+    {
+        return _data + row*_stride;
+    }
+
+    const Type *operator[](const size_t row) const
+    {
+        return _data + row*_stride;
+    }
+
+private:
+    std::vector<Type> _storage;
+    Type *_data;
+    size_t _rows;
+    size_t _stride;
+};
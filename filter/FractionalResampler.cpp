@@ -0,0 +1,447 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#include "FIRKernels.hpp"
+#include <Pothos/Framework.hpp>
+#include <Pothos/Util/QFormat.hpp>
+#include <spuce/filters/design_window.h>
+#include <cstdint>
+#include <complex>
+#include <cmath>
+#include <algorithm> //min/max
+#include <vector>
+
+using Pothos::Util::fromQ;
+using Pothos::Util::floatToQ;
+
+//the position of the next output in input samples, with 32 fractional bits
+static const double FRACTIONAL_ONE = 4294967296.0;
+
+//relative change of the prototype cutoff that redesigns the taps,
+//smaller ratio changes (such as clock drift) keep the current taps
+static const double CUTOFF_TOLERANCE = 0.01;
+
+/***********************************************************************
+ * Prototype low pass filter at the polyphase rate:
+ * A windowed sinc of phases*numTaps taps with the cutoff in cycles
+ * per input sample, normalized for unity gain in each phase.
+ **********************************************************************/
+static std::vector<double> designResamplerPrototype(const size_t phases, const size_t numTaps, const double cutoff)
+{
+    const size_t N = phases*numTaps;
+    const double centre = (N-1)/2.0;
+    const auto window = spuce::design_window("kaiser", N, 8.0);
+    std::vector<double> taps(N);
+    double sum = 0.0;
+    for (size_t n = 0; n < N; n++)
+    {
+        const double x = 2*M_PI*cutoff*(n-centre)/phases;
+        taps[n] = ((x == 0.0)?1.0:(std::sin(x)/x))*window[n];
+        sum += taps[n];
+    }
+    for (auto &tap : taps) tap *= phases/sum;
+    return taps;
+}
+
+/***********************************************************************
+ * |PothosDoc Fractional Resampler
+ *
+ * The fractional resampler changes the sample rate of an input element stream
+ * from port 0 by an arbitrary ratio to produce an output element stream on port 0.
+ * Unlike the FIR filter, the ratio does not need to be a fraction of small integers:
+ * ratios such as 1.000137 for clock drift correction or 48000/44100.5 are supported
+ * with a small filter bank, rather than a huge interpolation factor and table of taps.
+ *
+ * The resampler uses a bank of polyphase filters from a windowed sinc prototype.
+ * Each output is interpolated between the filter phases with a Farrow structure:
+ * each phase has one sub-filter per polynomial coefficient,
+ * and the fractional phase evaluates the polynomial of the sub-filter outputs.
+ * Linear interpolation computes 2 sub-filters per output, cubic computes 4.
+ *
+ * <a href="https://en.wikipedia.org/wiki/Sample-rate_conversion">
+ * https://en.wikipedia.org/wiki/Sample-rate_conversion</a>
+ *
+ * <h2>Changing the ratio</h2>
+ *
+ * The ratio can be changed at runtime with the setter,
+ * or in the stream with a label matching the ratio ID.
+ * The ratio label carries the new ratio as a double,
+ * and takes effect at the first output after the labeled element.
+ * Labels with the ratio ID and any other data type are ignored.
+ * The filter taps are only redesigned when a ratio below 1
+ * changes the cutoff by more than 1 percent.
+ *
+ * |category /Filter
+ * |keywords filter resample fractional farrow polyphase interpolate decimate drift
+ *
+ * |param dtype[Data Type] The data type of the input and output element stream.
+ * |widget DTypeChooser(float=1,cfloat=1,int=1,cint=1)
+ * |default "complex_float32"
+ * |preview disable
+ *
+ * |param ratio[Ratio] The output sample rate divided by the input sample rate.
+ * The ratio has a resolution of 2^-32 input elements per output element.
+ * |default 1.0
+ *
+ * |param interp[Interpolation] The polynomial interpolation between the filter phases.
+ * |option [Linear] "LINEAR"
+ * |option [Cubic] "CUBIC"
+ * |default "LINEAR"
+ *
+ * |param phases[Phases] The number of phases in the polyphase filter bank.
+ * More phases reduce the interpolation error at the cost of a larger bank.
+ * |default 32
+ * |widget SpinBox(minimum=1)
+ * |preview valid
+ *
+ * |param numTaps[Taps per Phase] The number of filter taps in each phase.
+ * More taps narrow the transition band at the cost of computation per output.
+ * |default 32
+ * |widget SpinBox(minimum=1)
+ * |preview valid
+ *
+ * |param bandwidth[Bandwidth] The cutoff of the prototype filter
+ * as a fraction of the Nyquist frequency of the lower of the input and output rates.
+ * |default 0.8
+ * |preview valid
+ *
+ * |param ratioId[Ratio ID] The label ID to change the ratio in the stream.
+ * An empty string (default) disables this feature.
+ * |default ""
+ * |widget StringEntry()
+ * |preview valid
+ * |tab Labels
+ *
+ * |factory /comms/fractional_resampler(dtype)
+ * |setter setRatio(ratio)
+ * |setter setInterpolation(interp)
+ * |setter setPhases(phases)
+ * |setter setNumTaps(numTaps)
+ * |setter setBandwidth(bandwidth)
+ * |setter setRatioId(ratioId)
+ **********************************************************************/
+template <typename Type, typename QType, typename QTapsType>
+class FractionalResampler : public Pothos::Block
+{
+    typedef FIRKernels<QType, QTapsType, Type> Kernels;
+    typedef typename Kernels::TapsScalar TapsScalar;
+
+public:
+    FractionalResampler(void):
+        _ratio(1.0),
+        _order(1),
+        _numPhases(32),
+        _numTaps(32),
+        _bandwidth(0.8),
+        _cutoff(0.0),
+        _step(0),
+        _pos(0),
+        _labelStart(0.0),
+        _labelStep(1.0),
+        _labelOutputs(0)
+    {
+        this->setupInput(0, typeid(Type));
+        this->setupOutput(0, typeid(Type));
+        this->registerCall(this, POTHOS_FCN_TUPLE(FractionalResampler, setRatio));
+        this->registerCall(this, POTHOS_FCN_TUPLE(FractionalResampler, getRatio));
+        this->registerCall(this, POTHOS_FCN_TUPLE(FractionalResampler, setInterpolation));
+        this->registerCall(this, POTHOS_FCN_TUPLE(FractionalResampler, getInterpolation));
+        this->registerCall(this, POTHOS_FCN_TUPLE(FractionalResampler, setPhases));
+        this->registerCall(this, POTHOS_FCN_TUPLE(FractionalResampler, getPhases));
+        this->registerCall(this, POTHOS_FCN_TUPLE(FractionalResampler, setNumTaps));
+        this->registerCall(this, POTHOS_FCN_TUPLE(FractionalResampler, getNumTaps));
+        this->registerCall(this, POTHOS_FCN_TUPLE(FractionalResampler, setBandwidth));
+        this->registerCall(this, POTHOS_FCN_TUPLE(FractionalResampler, getBandwidth));
+        this->registerCall(this, POTHOS_FCN_TUPLE(FractionalResampler, setRatioId));
+        this->registerCall(this, POTHOS_FCN_TUPLE(FractionalResampler, getRatioId));
+        this->setRatio(1.0); //initial update
+    }
+
+    void setRatio(const double ratio)
+    {
+        if (not (ratio > 0.0)) throw Pothos::InvalidArgumentException("FractionalResampler::setRatio()", "ratio must be positive");
+        const auto step = uint64_t(std::llround(FRACTIONAL_ONE/ratio));
+        if (step == 0) throw Pothos::InvalidArgumentException("FractionalResampler::setRatio()", "ratio too large");
+        _ratio = ratio;
+        _step = step;
+        this->updateTaps();
+    }
+
+    double getRatio(void) const
+    {
+        return _ratio;
+    }
+
+    void setInterpolation(const std::string &interp)
+    {
+        if (interp == "LINEAR") _order = 1;
+        else if (interp == "CUBIC") _order = 3;
+        else throw Pothos::InvalidArgumentException("FractionalResampler::setInterpolation()", "unknown interpolation: " + interp);
+        this->updateTaps(true);
+    }
+
+    std::string getInterpolation(void) const
+    {
+        return (_order == 1)?"LINEAR":"CUBIC";
+    }
+
+    void setPhases(const size_t phases)
+    {
+        if (phases == 0) throw Pothos::InvalidArgumentException("FractionalResampler::setPhases()", "phases cannot be 0");
+        _numPhases = phases;
+        this->updateTaps(true);
+    }
+
+    size_t getPhases(void) const
+    {
+        return _numPhases;
+    }
+
+    void setNumTaps(const size_t numTaps)
+    {
+        if (numTaps == 0) throw Pothos::InvalidArgumentException("FractionalResampler::setNumTaps()", "taps per phase cannot be 0");
+        _numTaps = numTaps;
+        this->updateTaps(true);
+    }
+
+    size_t getNumTaps(void) const
+    {
+        return _numTaps;
+    }
+
+    void setBandwidth(const double bandwidth)
+    {
+        if (bandwidth <= 0.0 or bandwidth > 1.0) throw Pothos::InvalidArgumentException("FractionalResampler::setBandwidth()", "bandwidth must be within (0.0, 1.0]");
+        _bandwidth = bandwidth;
+        this->updateTaps(true);
+    }
+
+    double getBandwidth(void) const
+    {
+        return _bandwidth;
+    }
+
+    void setRatioId(const std::string &id)
+    {
+        _ratioId = id;
+    }
+
+    std::string getRatioId(void) const
+    {
+        return _ratioId;
+    }
+
+    //! always use a circular buffer to avoid discontinuity over sliding window
+    Pothos::BufferManager::Sptr getInputBufferManager(const std::string &, const std::string &)
+    {
+        return Pothos::BufferManager::make("circular");
+    }
+
+    void activate(void)
+    {
+        _pos = 0;
+    }
+
+    void work(void)
+    {
+        const size_t K = _numTaps;
+        auto inPort = this->input(0);
+        auto outPort = this->output(0);
+        _labelOutputs = 0;
+
+        /***************************************************************
+         * apply ratio labels up to the next output, stop at later ones
+         **************************************************************/
+        //positions are relative to the oldest of the K-1 history elements
+        size_t inputAvailable = inPort->elements();
+        size_t labelLimit = inputAvailable;
+        if (not _ratioId.empty()) for (const auto &label : inPort->labels())
+        {
+            if (label.id != _ratioId or label.data.type() != typeid(double)) continue;
+            if (label.index <= (_pos >> 32)) this->setRatio(label.data.template extract<double>());
+            else
+            {
+                labelLimit = label.index;
+                inputAvailable = std::min(inputAvailable, labelLimit+(K-1));
+                break;
+            }
+        }
+
+        //the next output needs the element at its position and K-1 newer ones
+        const size_t inputRequire = size_t(_pos >> 32) + K;
+        if (inputAvailable < inputRequire)
+        {
+            if (inPort->elements() < inputRequire) inPort->setReserve(inputRequire);
+            return;
+        }
+        inPort->setReserve(0);
+
+        /***************************************************************
+         * compute an output for each position within the input
+         **************************************************************/
+        const Type *x = inPort->buffer();
+        Type *y = outPort->buffer();
+        const size_t maxOut = outPort->elements();
+        const uint64_t end = uint64_t(inputAvailable-(K-1)) << 32;
+        _labelStart = _pos/FRACTIONAL_ONE;
+        _labelStep = _step/FRACTIONAL_ONE;
+
+        size_t numOut = 0;
+        uint64_t pos = _pos;
+        while (pos < end and numOut < maxOut)
+        {
+            //the fraction selects the phase, the remainder of the phase is mu
+            const uint64_t phase = (pos & 0xffffffff)*_numPhases;
+            const double mu = uint32_t(phase)/FRACTIONAL_ONE;
+            this->farrow(size_t(phase >> 32), x + size_t(pos >> 32), mu, y[numOut++]);
+            pos += _step;
+        }
+
+        //consume up to the next position, but not past a pending ratio label
+        const size_t consumed = size_t(std::min<uint64_t>(pos >> 32, labelLimit));
+        _pos = pos - (uint64_t(consumed) << 32);
+        _labelOutputs = numOut;
+        inPort->consume(consumed);
+        outPort->produce(numOut);
+    }
+
+    void propagateLabels(const Pothos::InputPort *port)
+    {
+        //each label moves to the first output at or after its position
+        auto outputPort = this->output(0);
+        for (const auto &label : port->labels())
+        {
+            auto newLabel = label;
+            const double index = std::ceil((label.index - _labelStart)/_labelStep);
+            newLabel.index = size_t(std::min(std::max(index, 0.0), double(_labelOutputs)));
+            newLabel.width = std::max<size_t>(1, size_t(std::llround(label.width/_labelStep)));
+            if (label.id == "rxRate" and label.data.type() == typeid(double))
+            {
+                newLabel.data = Pothos::Object(double(label.data)/_labelStep);
+            }
+            outputPort->postLabel(std::move(newLabel));
+        }
+    }
+
+private:
+    void dotRow(const size_t row, const Type *x, QType &y) const
+    {
+        if (_dots[row] == nullptr) Kernels::dotScalar(_taps[row], x, _numTaps, y);
+        else _dots[row](_taps[row], x, _numTaps, y);
+    }
+
+    //! Evaluate the polynomial of the phase sub-filters with Horner's method
+    void farrow(const size_t phase, const Type *x, const double mu, Type &y) const
+    {
+        const size_t row = phase*(_order+1);
+        QType acc;
+        this->dotRow(row+_order, x, acc);
+        for (size_t m = _order; m-- > 0;)
+        {
+            QType c;
+            this->dotRow(row+m, x, c);
+            acc = hornerQ(acc, mu, c);
+        }
+        y = fromQ<Type>(acc);
+    }
+
+    //a*mu + c in the fixed or floating point Q domain
+    template <typename T>
+    static T hornerQ(const T &a, const double mu, const T &c)
+    {
+        return T(a*mu + c);
+    }
+
+    template <typename T>
+    static std::complex<T> hornerQ(const std::complex<T> &a, const double mu, const std::complex<T> &c)
+    {
+        return std::complex<T>(hornerQ(a.real(), mu, c.real()), hornerQ(a.imag(), mu, c.imag()));
+    }
+
+    /*!
+     * Design the prototype and build the Farrow sub-filters.
+     * The cutoff follows the lower of the input and output rates,
+     * so a ratio change only redesigns the taps below a ratio of 1,
+     * and only when the cutoff moves by more than the tolerance.
+     */
+    void updateTaps(const bool force = false)
+    {
+        const double cutoff = _bandwidth*std::min(1.0, _ratio)/2;
+        if (not force and std::abs(cutoff-_cutoff) <= CUTOFF_TOLERANCE*_cutoff) return;
+        _cutoff = cutoff;
+
+        //the prototype at the polyphase rate, zero outside of its length
+        const size_t P = _numPhases, K = _numTaps;
+        const auto proto = designResamplerPrototype(P, K, cutoff);
+        const auto g = [&proto](const size_t t, const int j) -> double
+        {
+            const auto i = ptrdiff_t(t)+j;
+            return (i < 0 or size_t(i) >= proto.size())?0.0:proto[i];
+        };
+
+        //each phase tap is a polynomial in mu through the neighbouring prototype taps:
+        //linear through g(t) and g(t+1), cubic Lagrange through g(t-1) to g(t+2)
+        const size_t rows = P*(_order+1);
+        _taps.resize(rows, Kernels::packedSize(K));
+        _dots.resize(rows);
+        std::vector<std::vector<QTapsType>> coeffs(_order+1, std::vector<QTapsType>(K));
+        for (size_t p = 0; p < P; p++)
+        {
+            for (size_t k = 0; k < K; k++)
+            {
+                //taps are time-reversed for the kernels
+                const size_t t = p + k*P, r = K-1-k;
+                const double gm1 = g(t, -1), g0 = g(t, 0), g1 = g(t, 1), g2 = g(t, 2);
+                coeffs[0][r] = floatToQ<QTapsType>(g0);
+                if (_order == 1) coeffs[1][r] = floatToQ<QTapsType>(g1 - g0);
+                else
+                {
+                    coeffs[1][r] = floatToQ<QTapsType>(-gm1/3 - g0/2 + g1 - g2/6);
+                    coeffs[2][r] = floatToQ<QTapsType>(gm1/2 - g0 + g1/2);
+                    coeffs[3][r] = floatToQ<QTapsType>(-gm1/6 + g0/2 - g1/2 + g2/6);
+                }
+            }
+            for (size_t m = 0; m <= _order; m++)
+            {
+                const size_t row = p*(_order+1)+m;
+                Kernels::pack(coeffs[m].data(), K, _taps[row]);
+                _dots[row] = Kernels::dot(K);
+            }
+        }
+    }
+
+    double _ratio;
+    size_t _order;
+    size_t _numPhases;
+    size_t _numTaps;
+    double _bandwidth;
+    double _cutoff;
+    uint64_t _step;
+    uint64_t _pos;
+    std::string _ratioId;
+    FIRTapsMatrix<TapsScalar> _taps;
+    std::vector<typename Kernels::DotFcn> _dots;
+    double _labelStart;
+    double _labelStep;
+    size_t _labelOutputs;
+};
+
+/***********************************************************************
+ * registration
+ **********************************************************************/
+static Pothos::Block *FractionalResamplerFactory(const Pothos::DType &dtype)
+{
+    #define ifTypeDeclareFactory_(Type, QType, QTapsType) \
+        if (dtype == Pothos::DType(typeid(Type))) return new FractionalResampler<Type, QType, QTapsType>();
+    #define ifTypeDeclareFactory(type, qtype) \
+        ifTypeDeclareFactory_(type, qtype, qtype) \
+        ifTypeDeclareFactory_(std::complex<type>, std::complex<qtype>, qtype)
+    ifTypeDeclareFactory(double, double);
+    ifTypeDeclareFactory(float, float);
+    ifTypeDeclareFactory(int64_t, int64_t);
+    ifTypeDeclareFactory(int32_t, int64_t);
+    ifTypeDeclareFactory(int16_t, int32_t);
+    ifTypeDeclareFactory(int8_t, int16_t);
+    throw Pothos::InvalidArgumentException("FractionalResamplerFactory("+dtype.toString()+")", "unsupported types");
+}
+static Pothos::BlockRegistry registerFractionalResampler(
+    "/comms/fractional_resampler", &FractionalResamplerFactory);
@@ -0,0 +1,482 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#include "FIRKernels.hpp"
+#include <Pothos/Framework.hpp>
+#include <Pothos/Util/QFormat.hpp>
+#include <cstdint>
+#include <complex>
+#include <algorithm> //min/max, copy
+#include <vector>
+
+using Pothos::Util::fromQ;
+using Pothos::Util::floatToQ;
+
+/***********************************************************************
+ * One decimate or interpolate by 2 stage of a half-band filter:
+ *
+ * A half-band filter with an odd centre index c has zero taps
+ * at every even offset from the centre, except for the centre itself.
+ * The non-zero taps h[2k] act on one polyphase branch of the input
+ * (decimation) or produce one polyphase branch of the output (interpolation),
+ * while the other branch is only the centre tap times a delayed sample.
+ * Only the non-zero taps are stored, time-reversed in the kernel layout.
+ **********************************************************************/
+template <typename Type, typename QType, typename QTapsType>
+class HalfbandStage
+{
+    typedef FIRKernels<QType, QTapsType, Type> Kernels;
+    typedef typename Kernels::TapsScalar TapsScalar;
+
+public:
+    HalfbandStage(const std::vector<double> &taps, const bool interp):
+        _interp(interp),
+        _numTaps((taps.size()+1)/2),
+        _centreDelay((taps.size()-3)/4),
+        _dot(nullptr)
+    {
+        //interpolation zero-stuffs half of the samples, a gain of 2 restores the amplitude
+        const double gain = interp?2.0:1.0;
+        std::vector<QTapsType> revTaps(_numTaps);
+        for (size_t k = 0; k < _numTaps; k++) revTaps[_numTaps-1-k] = floatToQ<QTapsType>(gain*taps[2*k]);
+        _centre = floatToQ<QTapsType>(gain*taps[taps.size()/2]);
+        _taps.resize(1, Kernels::packedSize(_numTaps));
+        Kernels::pack(revTaps.data(), _numTaps, _taps[0]);
+        _dot = Kernels::dot(_numTaps, Kernels::symmetry(revTaps.data(), _numTaps));
+        this->reset();
+    }
+
+    //! Zero the filter history
+    void reset(void)
+    {
+        _hist[0].assign(_interp?(_numTaps-1):_centreDelay, Type(0));
+        _hist[1].assign(_interp?0:(_numTaps-1), Type(0));
+    }
+
+    //! The number of zeros appended to the input to flush the filter
+    size_t flushLength(const size_t numIn) const
+    {
+        if (_interp) return _numTaps-1;
+        const size_t numZeros = 2*_numTaps-2;
+        return numZeros + (numIn+numZeros)%2;
+    }
+
+    //! The number of outputs for the given number of inputs
+    size_t numOutputs(const size_t numIn, const bool flush) const
+    {
+        const size_t total = numIn + (flush?this->flushLength(numIn):0);
+        return _interp?(2*total):(total/2);
+    }
+
+    /*!
+     * Filter the input into the output and return the number of outputs.
+     * Without flush, the number of inputs must be even for decimation.
+     * With flush, zeros are appended to produce the entire filter tail,
+     * and the history is reset for the next burst.
+     */
+    size_t process(const Type *in, const size_t numIn, Type *out, const bool flush)
+    {
+        const size_t total = numIn + (flush?this->flushLength(numIn):0);
+        const size_t numOut = _interp?this->interpolate(in, numIn, total, out):this->decimate(in, numIn, total, out);
+        if (flush) this->reset();
+        return numOut;
+    }
+
+private:
+    void dot(const Type *x, QType &y) const
+    {
+        if (_dot == nullptr) Kernels::dotScalar(_taps[0], x, _numTaps, y);
+        else _dot(_taps[0], x, _numTaps, y);
+    }
+
+    size_t decimate(const Type *in, const size_t numIn, const size_t total, Type *out)
+    {
+        //split the input into its polyphase branches after the history:
+        //the even branch feeds the centre tap, the odd branch the other taps
+        auto &even = _hist[0], &odd = _hist[1];
+        const size_t histEven = even.size(), histOdd = odd.size();
+        //resize() value-initializes the new elements, which are the zeros for flush
+        const size_t numOut = total/2;
+        even.resize(histEven+numOut);
+        odd.resize(histOdd+numOut);
+        Type *evenIn = even.data()+histEven, *oddIn = odd.data()+histOdd;
+        for (size_t m = 0; m < numIn/2; m++)
+        {
+            evenIn[m] = in[2*m+0];
+            oddIn[m] = in[2*m+1];
+        }
+        if (numIn%2 == 1) evenIn[numIn/2] = in[numIn-1];
+
+        //the centre tap is added in a separate pass over the accumulators,
+        //rather than reading back each dot product right after it is stored
+        _acc.resize(numOut);
+        for (size_t m = 0; m < numOut; m++) this->dot(odd.data()+m, _acc[m]);
+        for (size_t m = 0; m < numOut; m++) out[m] = fromQ<Type>(QType(_acc[m] + _centre*QType(even[m])));
+
+        //keep the most recent samples as history
+        std::copy(even.end()-histEven, even.end(), even.begin());
+        std::copy(odd.end()-histOdd, odd.end(), odd.begin());
+        even.resize(histEven);
+        odd.resize(histOdd);
+        return numOut;
+    }
+
+    size_t interpolate(const Type *in, const size_t numIn, const size_t total, Type *out)
+    {
+        //the even outputs use the taps, the odd outputs the delayed centre tap
+        auto &x = _hist[0];
+        const size_t hist = x.size();
+        x.resize(hist+total); //value-initialized zeros for flush
+        std::copy(in, in+numIn, x.begin()+hist);
+
+        for (size_t j = 0; j < total; j++)
+        {
+            QType y;
+            this->dot(x.data()+j, y);
+            out[2*j+0] = fromQ<Type>(y);
+            out[2*j+1] = fromQ<Type>(QType(_centre*QType(x[j+hist-_centreDelay])));
+        }
+
+        std::copy(x.end()-hist, x.end(), x.begin());
+        x.resize(hist);
+        return 2*total;
+    }
+
+    const bool _interp;
+    const size_t _numTaps; //non-zero taps excluding the centre
+    const size_t _centreDelay; //centre tap delay in samples of the branch
+    FIRTapsMatrix<TapsScalar> _taps;
+    typename Kernels::DotFcn _dot;
+    QTapsType _centre;
+    std::vector<Type> _hist[2];
+    std::vector<QType> _acc;
+};
+
+/***********************************************************************
+ * |PothosDoc Half-band Filter
+ *
+ * The half-band filter decimates or interpolates an input element stream
+ * from port 0 by a power of 2 to produce an output element stream on port 0.
+ * Each stage changes the rate by 2 with the same half-band filter taps.
+ *
+ * A half-band filter has its cutoff at a quarter of the sample rate,
+ * so that every other tap is zero except for the centre tap.
+ * Only the non-zero taps are computed, and only for the decimated
+ * (or non-trivial interpolated) outputs, which is about a quarter
+ * of the multiplies of a generic FIR filter that decimates by 2.
+ *
+ * <a href="https://en.wikipedia.org/wiki/Half-band_filter">
+ * https://en.wikipedia.org/wiki/Half-band_filter</a>
+ *
+ * <h2>Burst support</h2>
+ *
+ * The half-band filter supports bursts with the same labels as the FIR filter.
+ * When a burst is encountered, the filter appends zeros to flush out the
+ * remainder of the burst from every stage without consuming or convolving
+ * with any of the samples from the next burst.
+ *
+ * Unlike the FIR filter, which outputs one element per decimation of the burst,
+ * each burst starts from a zero filter history and ends with the entire filter tail.
+ * With T taps after the zero ends are removed, a stage outputs (L+T)/2 elements
+ * (rounded down) for a burst of L elements when decimating,
+ * and 2*L+T-1 elements when interpolating.
+ * Each stage applies to the output of the previous stage.
+ *
+ * |category /Filter
+ * |keywords fir filter halfband decimate interpolate resample
+ *
+ * |param dtype[Data Type] The data type of the input and output element stream.
+ * |widget DTypeChooser(float=1,cfloat=1,int=1,cint=1)
+ * |default "complex_float32"
+ * |preview disable
+ *
+ * |param mode[Mode] Decimate or interpolate by 2 in each stage.
+ * |option [Decimate] "DECIMATE"
+ * |option [Interpolate] "INTERPOLATE"
+ * |default "DECIMATE"
+ *
+ * |param stages[Stages] The number of cascaded stages.
+ * The rate changes by a factor of 2 to the power of the number of stages.
+ * |default 1
+ * |widget SpinBox(minimum=1)
+ *
+ * |param taps The half-band filter taps with an odd length.
+ * The taps at an even non-zero offset from the centre are assumed to be zero and ignored.
+ * Leading and trailing taps at such offsets are removed from the filter.
+ * The taps are scaled by 2 for interpolation so a unity gain design preserves the amplitude.
+ * |default [0.005093, 0, -0.042213, 0, 0.290346, 0.5, 0.290346, 0, -0.042213, 0, 0.005093]
+ *
+ * |param frameStartId[Frame Start ID] The label ID to mark the first element of a burst.
+ * When the start frame ID is specified and the start frame label contains an element length,
+ * the filter will flush out the remainder of the burst without consuming the next burst.
+ * An empty string (default) disables this feature.
+ * |default ""
+ * |widget StringEntry()
+ * |preview valid
+ * |tab Labels
+ *
+ * |param frameEndId[Frame End ID] The label ID to mark the last element of a burst.
+ * Rather than using a start frame label with a length, when the end frame ID is specified,
+ * the filter will flush out the remainder of the burst without consuming the next burst.
+ * An empty string (default) disables this feature.
+ * |default ""
+ * |widget StringEntry()
+ * |preview valid
+ * |tab Labels
+ *
+ * |factory /comms/halfband_filter(dtype)
+ * |setter setMode(mode)
+ * |setter setStages(stages)
+ * |setter setTaps(taps)
+ * |setter setFrameStartId(frameStartId)
+ * |setter setFrameEndId(frameEndId)
+ **********************************************************************/
+template <typename Type, typename QType, typename QTapsType>
+class HalfbandFilter : public Pothos::Block
+{
+public:
+    HalfbandFilter(void):
+        _mode("DECIMATE"),
+        _numStages(1),
+        _factor(2),
+        _eobSampsLeft(0)
+    {
+        this->setupInput(0, typeid(Type));
+        this->setupOutput(0, typeid(Type));
+        this->registerCall(this, POTHOS_FCN_TUPLE(HalfbandFilter, setMode));
+        this->registerCall(this, POTHOS_FCN_TUPLE(HalfbandFilter, getMode));
+        this->registerCall(this, POTHOS_FCN_TUPLE(HalfbandFilter, setStages));
+        this->registerCall(this, POTHOS_FCN_TUPLE(HalfbandFilter, getStages));
+        this->registerCall(this, POTHOS_FCN_TUPLE(HalfbandFilter, setTaps));
+        this->registerCall(this, POTHOS_FCN_TUPLE(HalfbandFilter, getTaps));
+        this->registerCall(this, POTHOS_FCN_TUPLE(HalfbandFilter, setFrameStartId));
+        this->registerCall(this, POTHOS_FCN_TUPLE(HalfbandFilter, getFrameStartId));
+        this->registerCall(this, POTHOS_FCN_TUPLE(HalfbandFilter, setFrameEndId));
+        this->registerCall(this, POTHOS_FCN_TUPLE(HalfbandFilter, getFrameEndId));
+        this->setTaps({0.005093, 0, -0.042213, 0, 0.290346, 0.5, 0.290346, 0, -0.042213, 0, 0.005093}); //initial update
+    }
+
+    void setMode(const std::string &mode)
+    {
+        if (mode == "DECIMATE"){}
+        else if (mode == "INTERPOLATE"){}
+        else throw Pothos::InvalidArgumentException("HalfbandFilter::setMode()", "unknown mode: " + mode);
+        _mode = mode;
+        this->updateInternals();
+    }
+
+    std::string getMode(void) const
+    {
+        return _mode;
+    }
+
+    void setStages(const size_t stages)
+    {
+        if (stages == 0) throw Pothos::InvalidArgumentException("HalfbandFilter::setStages()", "stages cannot be 0");
+        _numStages = stages;
+        this->updateInternals();
+    }
+
+    size_t getStages(void) const
+    {
+        return _numStages;
+    }
+
+    void setTaps(const std::vector<double> &taps)
+    {
+        //remove zero taps from the ends until the centre index is odd
+        std::vector<double> trimmed(taps);
+        while (trimmed.size() >= 5 and (trimmed.size()/2)%2 == 0)
+        {
+            trimmed.pop_back();
+            trimmed.erase(trimmed.begin());
+        }
+        if (trimmed.size() < 3 or trimmed.size()%2 == 0)
+        {
+            throw Pothos::InvalidArgumentException("HalfbandFilter::setTaps()", "taps must have an odd length of at least 3");
+        }
+        _taps = taps;
+        _stageTaps = trimmed;
+        this->updateInternals();
+    }
+
+    std::vector<double> getTaps(void) const
+    {
+        return _taps;
+    }
+
+    void setFrameStartId(std::string id)
+    {
+        _frameStartId = id;
+    }
+
+    std::string getFrameStartId(void) const
+    {
+        return _frameStartId;
+    }
+
+    void setFrameEndId(std::string id)
+    {
+        _frameEndId = id;
+    }
+
+    std::string getFrameEndId(void) const
+    {
+        return _frameEndId;
+    }
+
+    void activate(void)
+    {
+        _eobSampsLeft = 0;
+        for (auto &stage : _stages) stage.reset();
+    }
+
+    void work(void)
+    {
+        auto inPort = this->input(0);
+        auto outPort = this->output(0);
+        const bool interp = _mode == "INTERPOLATE";
+        auto inputAvailable = inPort->elements();
+        if (inputAvailable == 0) return;
+
+        /***************************************************************
+         * search for burst labels and record the next end of burst
+         **************************************************************/
+        if (_eobSampsLeft == 0) for (const auto &label : inPort->labels())
+        {
+            if (not _frameStartId.empty() and label.id == _frameStartId and label.data.canConvert(typeid(size_t)))
+            {
+                const auto length = label.data.template convert<size_t>();
+                _eobSampsLeft = label.index + length*label.width;
+                break;
+            }
+            else if (not _frameEndId.empty() and label.id == _frameEndId)
+            {
+                _eobSampsLeft = label.index + label.width;
+                break;
+            }
+        }
+
+        //in burst mode, make sure input available stops at the end
+        if (_eobSampsLeft != 0)
+        {
+            if (_eobSampsLeft <= inputAvailable)
+            {
+                inputAvailable = _eobSampsLeft;
+            }
+            else
+            {
+                inPort->setReserve(_eobSampsLeft);
+                return;
+            }
+        }
+
+        //the decimator consumes whole multiples of the rate
+        const size_t inputMultiple = interp?1:_factor;
+        inPort->setReserve(0);
+
+        /***************************************************************
+         * flush the end of burst or process whole multiples
+         **************************************************************/
+        const auto outputAvailable = outPort->elements();
+        size_t numIn = inputAvailable;
+        const bool flush = _eobSampsLeft != 0 and this->numOutputs(numIn, true) <= outputAvailable;
+        if (not flush)
+        {
+            //leave at least one element of the burst for the flush,
+            //so that the tail is produced and the history is reset
+            if (_eobSampsLeft != 0) numIn = _eobSampsLeft-1;
+            numIn = std::min(numIn, interp?(outputAvailable/_factor):(outputAvailable*_factor));
+            numIn = (numIn/inputMultiple)*inputMultiple;
+            if (numIn == 0)
+            {
+                //otherwise wait for the output space of the flush
+                if (_eobSampsLeft == 0) inPort->setReserve(inputMultiple);
+                return;
+            }
+        }
+
+        //each stage filters into the input of the next, the last into the output port
+        const Type *in = inPort->buffer();
+        size_t n = numIn;
+        for (size_t i = 0; i < _stages.size(); i++)
+        {
+            Type *out = outPort->buffer();
+            if (i+1 != _stages.size())
+            {
+                _stageBuffs[i].resize(_stages[i].numOutputs(n, flush));
+                out = _stageBuffs[i].data();
+            }
+            n = _stages[i].process(in, n, out, flush);
+            in = out;
+        }
+
+        if (_eobSampsLeft != 0) _eobSampsLeft -= numIn;
+        inPort->consume(numIn);
+        outPort->produce(n);
+    }
+
+    void propagateLabels(const Pothos::InputPort *port)
+    {
+        const bool interp = _mode == "INTERPOLATE";
+        const size_t L = interp?_factor:1, M = interp?1:_factor;
+        auto outputPort = this->output(0);
+        for (const auto &label : port->labels())
+        {
+            auto newLabel = label.toAdjusted(L, M);
+            if (label.id == "rxRate" and label.data.type() == typeid(double))
+            {
+                newLabel.data = Pothos::Object((double(label.data)*L)/M);
+            }
+            outputPort->postLabel(std::move(newLabel));
+        }
+    }
+
+private:
+    size_t numOutputs(size_t numIn, const bool flush) const
+    {
+        for (const auto &stage : _stages) numIn = stage.numOutputs(numIn, flush);
+        return numIn;
+    }
+
+    void updateInternals(void)
+    {
+        if (_stageTaps.empty()) return;
+        const bool interp = _mode == "INTERPOLATE";
+        _stages.clear();
+        for (size_t i = 0; i < _numStages; i++) _stages.emplace_back(_stageTaps, interp);
+        _stageBuffs.resize(_numStages-1);
+        _factor = size_t(1) << _numStages;
+    }
+
+    std::string _mode;
+    size_t _numStages;
+    size_t _factor;
+    std::vector<double> _taps;
+    std::vector<double> _stageTaps;
+    std::vector<HalfbandStage<Type, QType, QTapsType>> _stages;
+    std::vector<std::vector<Type>> _stageBuffs;
+    std::string _frameStartId;
+    std::string _frameEndId;
+    size_t _eobSampsLeft;
+};
+
+/***********************************************************************
+ * registration
+ **********************************************************************/
+static Pothos::Block *HalfbandFilterFactory(const Pothos::DType &dtype)
+{
+    #define ifTypeDeclareFactory_(Type, QType, QTapsType) \
+        if (dtype == Pothos::DType(typeid(Type))) return new HalfbandFilter<Type, QType, QTapsType>();
+    #define ifTypeDeclareFactory(type, qtype) \
+        ifTypeDeclareFactory_(type, qtype, qtype) \
+        ifTypeDeclareFactory_(std::complex<type>, std::complex<qtype>, qtype)
+    ifTypeDeclareFactory(double, double);
+    ifTypeDeclareFactory(float, float);
+    ifTypeDeclareFactory(int64_t, int64_t);
+    ifTypeDeclareFactory(int32_t, int64_t);
+    ifTypeDeclareFactory(int16_t, int32_t);
+    ifTypeDeclareFactory(int8_t, int16_t);
+    throw Pothos::InvalidArgumentException("HalfbandFilterFactory("+dtype.toString()+")", "unsupported types");
+}
+static Pothos::BlockRegistry registerHalfbandFilter(
+    "/comms/halfband_filter", &HalfbandFilterFactory);
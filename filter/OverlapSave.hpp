@@ -0,0 +1,104 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#pragma once
+#include "FFTAux.h"
+#include <complex>
+#include <vector>
+#include <cstddef>
+
+/*!
+ * Overlap-save fast convolution processing unit.
+ * The input is filtered in blocks by multiplication in the frequency domain.
+ * \see https://en.wikipedia.org/wiki/Overlap%E2%80%93save_method
+ */
+template <typename ComplexType>
+class OverlapSave
+{
+public:
+    /*!
+     * Create the convolution for the given taps and FFT size.
+     * The FFT size must be larger than the number of taps - 1.
+     */
+    template <typename TapsType>
+    OverlapSave(const std::vector<TapsType> &taps, const size_t fftSize):
+        _numTaps(taps.size()),
+        _fftSize(fftSize),
+        _fwdFFT(fftSize, false),
+        _invFFT(fftSize, true),
+        _timeBuff(fftSize),
+        _freqBuff(fftSize),
+        _freqTaps(fftSize)
+    {
+        //frequency domain taps, scaled to normalize the inverse transform
+        for (size_t i = 0; i < _fftSize; i++)
+        {
+            _timeBuff[i] = (i < _numTaps)?ComplexType(taps[i]):ComplexType(0);
+            _timeBuff[i] /= typename ComplexType::value_type(_fftSize);
+        }
+        _fwdFFT.transform(_timeBuff.data(), _freqTaps.data());
+    }
+
+    //! The number of new outputs computed for each block
+    size_t blockSize(void) const
+    {
+        return _fftSize-(_numTaps-1);
+    }
+
+    /*!
+     * Filter one block of input elements.
+     * The input points to numTaps-1 elements of filter history,
+     * followed by numIn new elements, where numIn <= blockSize().
+     * Every decim-th output (starting at decim-1) is written to out.
+     */
+    template <typename InType, typename OutType>
+    void filter(const InType *in, const size_t numIn, OutType *out, const size_t decim)
+    {
+        const size_t numHist = _numTaps-1;
+        for (size_t i = 0; i < numHist+numIn; i++) _timeBuff[i] = getInput(in[i]);
+        for (size_t i = numHist+numIn; i < _fftSize; i++) _timeBuff[i] = ComplexType(0);
+
+        _fwdFFT.transform(_timeBuff.data(), _freqBuff.data());
+        for (size_t i = 0; i < _fftSize; i++) _freqBuff[i] *= _freqTaps[i];
+        _invFFT.transform(_freqBuff.data(), _timeBuff.data());
+
+        //the first numTaps-1 outputs are aliased by the circular convolution
+        for (size_t i = decim-1; i < numIn; i += decim)
+        {
+            setOutput(_timeBuff[numHist+i], *out++);
+        }
+    }
+
+private:
+    template <typename InType>
+    static ComplexType getInput(const std::complex<InType> &in)
+    {
+        typedef typename ComplexType::value_type RealType;
+        return ComplexType(RealType(in.real()), RealType(in.imag()));
+    }
+
+    template <typename InType>
+    static ComplexType getInput(const InType &in)
+    {
+        return ComplexType(in);
+    }
+
+    template <typename OutType>
+    static void setOutput(const ComplexType &in, std::complex<OutType> &out)
+    {
+        out = std::complex<OutType>(OutType(in.real()), OutType(in.imag()));
+    }
+
+    template <typename OutType>
+    static void setOutput(const ComplexType &in, OutType &out)
+    {
+        out = OutType(in.real());
+    }
+
+    const size_t _numTaps;
+    const size_t _fftSize;
+    FFTAux<ComplexType> _fwdFFT;
+    FFTAux<ComplexType> _invFFT;
+    std::vector<ComplexType> _timeBuff;
+    std::vector<ComplexType> _freqBuff;
+    std::vector<ComplexType> _freqTaps;
+};
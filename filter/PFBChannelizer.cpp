@@ -0,0 +1,211 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#include "FIRKernels.hpp"
+#include "FFTAux.h"
+#include <Pothos/Framework.hpp>
+#include <complex>
+#include <algorithm> //min, copy
+#include <vector>
+
+/***********************************************************************
+ * |PothosDoc PFB Channelizer
+ *
+ * The polyphase filterbank channelizer splits the input element stream on port 0
+ * into evenly spaced channels, each decimated by the number of channels.
+ * Output port c produces the channel centred at c times the input rate
+ * divided by the number of channels; the upper half of the channels
+ * are the negative frequencies.
+ * Each channel is the input mixed by exp(-j*2*pi*c*n/N) for input index n,
+ * filtered by the prototype filter, and decimated by the number of channels N.
+ *
+ * The prototype low pass filter is split into one polyphase branch per channel.
+ * Each block of input elements produces one output element for every channel
+ * with one short filter per branch and one FFT across the branches.
+ * The cost per channel grows with the logarithm of the number of channels,
+ * rather than with the number of taps for a separate mixer and FIR filter per channel.
+ *
+ * <a href="https://en.wikipedia.org/wiki/Polyphase_quadrature_filter">
+ * https://en.wikipedia.org/wiki/Polyphase_quadrature_filter</a>
+ *
+ * |category /Filter
+ * |keywords filter channelizer polyphase filterbank pfb fft decimate
+ *
+ * |param dtype[Data Type] The data type of the input and output element streams.
+ * |widget DTypeChooser(cfloat=1)
+ * |default "complex_float32"
+ * |preview disable
+ *
+ * |param numChannels[Num Channels] The number of channels and output ports.
+ * |default 4
+ * |widget SpinBox(minimum=1)
+ * |preview disable
+ *
+ * |param taps The prototype low pass filter taps, at the input sample rate.
+ * A filter with a cutoff of half the channel spacing separates the channels.
+ * Manually enter or paste in FIR filter taps or leave this entry blank
+ * and use the FIR Designer taps signal to configure the filter taps at runtime.
+ * |default [1.0]
+ *
+ * |factory /comms/pfb_channelizer(dtype, numChannels)
+ * |setter setTaps(taps)
+ **********************************************************************/
+template <typename Type>
+class PFBChannelizer : public Pothos::Block
+{
+    typedef typename Type::value_type RealType;
+    typedef FIRKernels<Type, RealType, Type> Kernels;
+    typedef typename Kernels::TapsScalar TapsScalar;
+
+public:
+    PFBChannelizer(const size_t numChannels):
+        _numChannels(numChannels),
+        _numTaps(0),
+        _dot(nullptr),
+        _ifft(numChannels, true),
+        _branches(numChannels),
+        _fftIn(numChannels),
+        _fftOut(numChannels),
+        _outs(numChannels)
+    {
+        if (numChannels == 0) throw Pothos::InvalidArgumentException("PFBChannelizer()", "number of channels cannot be 0");
+        this->setupInput(0, typeid(Type));
+        for (size_t c = 0; c < _numChannels; c++) this->setupOutput(c, typeid(Type));
+        this->input(0)->setReserve(_numChannels);
+        this->registerCall(this, POTHOS_FCN_TUPLE(PFBChannelizer, setTaps));
+        this->registerCall(this, POTHOS_FCN_TUPLE(PFBChannelizer, getTaps));
+        this->setTaps(std::vector<double>(1, 1.0)); //initial update
+    }
+
+    void setTaps(const std::vector<double> &taps)
+    {
+        if (taps.empty()) throw Pothos::InvalidArgumentException("PFBChannelizer::setTaps()", "taps cannot be empty");
+        _taps = taps;
+
+        //branch k takes every N-th tap from k, zero padded to the same length,
+        //time-reversed in the kernel layout
+        const size_t N = _numChannels;
+        _numTaps = (taps.size() + N - 1)/N;
+        _branchTaps.resize(N, Kernels::packedSize(_numTaps));
+        std::vector<RealType> revTaps(_numTaps);
+        for (size_t k = 0; k < N; k++)
+        {
+            for (size_t m = 0; m < _numTaps; m++)
+            {
+                const size_t i = k + m*N;
+                revTaps[_numTaps-1-m] = (i < taps.size())?RealType(taps[i]):RealType(0);
+            }
+            Kernels::pack(revTaps.data(), _numTaps, _branchTaps[k]);
+        }
+        _dot = Kernels::dot(_numTaps);
+        this->resetBranches();
+    }
+
+    std::vector<double> getTaps(void) const
+    {
+        return _taps;
+    }
+
+    void activate(void)
+    {
+        this->resetBranches();
+    }
+
+    void work(void)
+    {
+        const size_t N = _numChannels;
+        auto inPort = this->input(0);
+
+        //one block of N inputs makes one output on every channel
+        size_t numBlocks = inPort->elements()/N;
+        for (size_t c = 0; c < N; c++)
+        {
+            auto outPort = this->output(c);
+            numBlocks = std::min(numBlocks, outPort->elements());
+            _outs[c] = outPort->buffer();
+        }
+        if (numBlocks == 0) return;
+
+        //commutate each block into the branches after their history:
+        //branch k takes the input N-1-k from the start of the block
+        const Type *in = inPort->buffer();
+        const size_t hist = _numTaps-1;
+        for (size_t k = 0; k < N; k++)
+        {
+            auto &branch = _branches[k];
+            branch.resize(hist+numBlocks);
+            Type *x = branch.data()+hist;
+            for (size_t b = 0; b < numBlocks; b++) x[b] = in[b*N + N-1-k];
+        }
+
+        //filter each branch, then combine the branches into the channels:
+        //branch k holds the inputs N-1-k modulo N, which the channel mixer
+        //rotates by c*(k+1) turns of 1/N, so it goes into bin k+1 of the inverse FFT
+        for (size_t b = 0; b < numBlocks; b++)
+        {
+            for (size_t k = 0; k < N; k++)
+            {
+                const Type *x = _branches[k].data()+b;
+                Type &y = _fftIn[(k+1)%N];
+                if (_dot == nullptr) Kernels::dotScalar(_branchTaps[k], x, _numTaps, y);
+                else _dot(_branchTaps[k], x, _numTaps, y);
+            }
+            _ifft.transform(_fftIn.data(), _fftOut.data());
+            for (size_t c = 0; c < N; c++) _outs[c][b] = _fftOut[c];
+        }
+
+        //keep the most recent inputs of each branch as history
+        for (auto &branch : _branches)
+        {
+            std::copy(branch.end()-hist, branch.end(), branch.begin());
+            branch.resize(hist);
+        }
+
+        inPort->consume(numBlocks*N);
+        for (size_t c = 0; c < N; c++) this->output(c)->produce(numBlocks);
+    }
+
+    void propagateLabels(const Pothos::InputPort *port)
+    {
+        const size_t N = _numChannels;
+        for (const auto &label : port->labels())
+        {
+            auto newLabel = label.toAdjusted(1, N);
+            if (label.id == "rxRate" and label.data.type() == typeid(double))
+            {
+                newLabel.data = Pothos::Object(double(label.data)/N);
+            }
+            for (size_t c = 0; c < N; c++) this->output(c)->postLabel(newLabel);
+        }
+    }
+
+private:
+    void resetBranches(void)
+    {
+        for (auto &branch : _branches) branch.assign(_numTaps-1, Type(0));
+    }
+
+    const size_t _numChannels;
+    std::vector<double> _taps;
+    size_t _numTaps;
+    FIRTapsMatrix<TapsScalar> _branchTaps;
+    typename Kernels::DotFcn _dot;
+    FFTAux<Type> _ifft;
+    std::vector<std::vector<Type>> _branches;
+    std::vector<Type> _fftIn;
+    std::vector<Type> _fftOut;
+    std::vector<Type *> _outs;
+};
+
+/***********************************************************************
+ * registration
+ **********************************************************************/
+static Pothos::Block *PFBChannelizerFactory(const Pothos::DType &dtype, const size_t numChannels)
+{
+    #define ifTypeDeclareFactory(Type) \
+        if (dtype == Pothos::DType(typeid(Type))) return new PFBChannelizer<Type>(numChannels);
+    ifTypeDeclareFactory(std::complex<double>);
+    ifTypeDeclareFactory(std::complex<float>);
+    throw Pothos::InvalidArgumentException("PFBChannelizerFactory("+dtype.toString()+")", "unsupported type");
+}
+static Pothos::BlockRegistry registerPFBChannelizer(
+    "/comms/pfb_channelizer", &PFBChannelizerFactory);
@@ -0,0 +1,224 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#include <Pothos/Testing.hpp>
+#include <Pothos/Framework.hpp>
+#include <Pothos/Proxy.hpp>
+#include <complex>
+#include <cstdint>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <iostream>
+
+/***********************************************************************
+ * Direct reference of the integrators at the high rate
+ * and the combs at the low rate, scaled by the inverse gain
+ **********************************************************************/
+static std::vector<int64_t> cicReference(
+    const std::vector<int64_t> &x,
+    const bool interp,
+    const size_t order,
+    const size_t rate,
+    const size_t delay)
+{
+    std::vector<int64_t> integ(order, 0);
+    std::vector<std::vector<int64_t>> combs(order, std::vector<int64_t>(delay, 0));
+    auto comb = [&](int64_t v)
+    {
+        for (auto &hist : combs)
+        {
+            const int64_t out = v - hist.front();
+            hist.erase(hist.begin());
+            hist.push_back(v);
+            v = out;
+        }
+        return v;
+    };
+    auto integrate = [&](int64_t v)
+    {
+        for (auto &acc : integ) v = (acc += v);
+        return v;
+    };
+
+    double gain = std::pow(double(rate*delay), double(order));
+    if (interp) gain /= rate;
+    const double invGain = 1.0/gain;
+
+    std::vector<int64_t> y;
+    for (size_t n = 0; n < x.size(); n++)
+    {
+        if (interp)
+        {
+            const int64_t c = comb(x[n]);
+            for (size_t j = 0; j < rate; j++) y.push_back(std::llround(integrate((j == 0)?c:0)*invGain));
+        }
+        else
+        {
+            const int64_t v = integrate(x[n]);
+            if (n%rate == rate-1) y.push_back(std::llround(comb(v)*invGain));
+        }
+    }
+    return y;
+}
+
+template <typename Type>
+static int64_t cicTestPart(const Type &x, const bool)
+{
+    return int64_t(x);
+}
+
+template <typename Type>
+static int64_t cicTestPart(const std::complex<Type> &x, const bool imag)
+{
+    return int64_t(imag?x.imag():x.real());
+}
+
+//an impulse in the real part and a step in the imaginary part,
+//the sum of both for real types
+template <typename Type>
+static Type cicTestValue(const int64_t impulse, const int64_t step, Type *)
+{
+    return Type(impulse + step);
+}
+
+template <typename Type>
+static std::complex<Type> cicTestValue(const int64_t impulse, const int64_t step, std::complex<Type> *)
+{
+    return std::complex<Type>(Type(impulse), Type(step));
+}
+
+template <typename Type>
+static void testCICFilter(const std::string &mode, const size_t diffDelay)
+{
+    const Pothos::DType dtype(typeid(Type));
+    std::cout << "Testing CIC filter on " << dtype.toString() << ", " << mode << " diffDelay " << diffDelay << std::endl;
+    const bool interp = mode == "INTERPOLATE";
+    const size_t order = 4, rate = 16;
+
+    auto feeder = Pothos::BlockRegistry::make("/blocks/feeder_source", dtype);
+    auto filter = Pothos::BlockRegistry::make("/comms/cic_filter", dtype);
+    filter.call("setMode", mode);
+    filter.call("setOrder", order);
+    filter.call("setRate", rate);
+    filter.call("setDiffDelay", diffDelay);
+    auto collector = Pothos::BlockRegistry::make("/blocks/collector_sink", dtype);
+
+    //buffer lengths which are not multiples of the rate
+    std::vector<Type> input;
+    for (const size_t numElems : {37, 1003, 944})
+    {
+        auto buffIn = Pothos::BufferChunk(dtype, numElems);
+        auto pIn = buffIn.as<Type *>();
+        for (size_t i = 0; i < numElems; i++)
+        {
+            const size_t n = input.size();
+            pIn[i] = cicTestValue((n == 5)?8000:0, (n >= 100)?-1000:0, static_cast<Type *>(nullptr));
+            input.push_back(pIn[i]);
+        }
+        feeder.call("feedBuffer", buffIn);
+    }
+
+    //run the topology
+    {
+        Pothos::Topology topology;
+        topology.connect(feeder, 0, filter, 0);
+        topology.connect(filter, 0, collector, 0);
+        topology.commit();
+        POTHOS_TEST_TRUE(topology.waitInactive(0.01));
+    }
+
+    Pothos::BufferChunk buffOut = collector.call("getBuffer");
+    POTHOS_TEST_EQUAL(buffOut.elements(), interp?(input.size()*rate):(input.size()/rate));
+    auto pOut = buffOut.as<const Type *>();
+    for (const bool imag : {false, true})
+    {
+        std::vector<int64_t> x;
+        for (const auto &in : input) x.push_back(cicTestPart(in, imag));
+        const auto y = cicReference(x, interp, order, rate, diffDelay);
+        POTHOS_TEST_EQUAL(y.size(), buffOut.elements());
+        for (size_t i = 0; i < y.size(); i++)
+        {
+            POTHOS_TEST_EQUAL(cicTestPart(pOut[i], imag), y[i]);
+        }
+    }
+}
+
+POTHOS_TEST_BLOCK("/comms/tests", test_cic_filter)
+{
+    for (const std::string mode : {"DECIMATE", "INTERPOLATE"})
+    {
+        for (size_t diffDelay = 1; diffDelay <= 2; diffDelay++)
+        {
+            testCICFilter<std::complex<int16_t>>(mode, diffDelay);
+            testCICFilter<int32_t>(mode, diffDelay);
+        }
+    }
+}
+
+static double cicToneGetMagnitude(
+    const size_t diffDelay,
+    const size_t compTaps,
+    const double freq //cycles per sample at the low rate
+)
+{
+    const Pothos::DType dtype("complex_int16");
+    const size_t rate = 16;
+    const size_t numOut = 400;
+
+    auto feeder = Pothos::BlockRegistry::make("/blocks/feeder_source", dtype);
+    auto filter = Pothos::BlockRegistry::make("/comms/cic_filter", dtype);
+    filter.call("setMode", "DECIMATE");
+    filter.call("setOrder", 4);
+    filter.call("setRate", rate);
+    filter.call("setDiffDelay", diffDelay);
+    filter.call("setCompTaps", compTaps);
+    filter.call("setCompCutoff", 0.2);
+    auto collector = Pothos::BlockRegistry::make("/blocks/collector_sink", dtype);
+
+    //complex tone with a constant magnitude
+    auto buffIn = Pothos::BufferChunk(dtype, numOut*rate);
+    auto pIn = buffIn.as<std::complex<int16_t> *>();
+    for (size_t i = 0; i < buffIn.elements(); i++)
+    {
+        const auto x = std::polar(8000.0, 2*M_PI*freq*i/rate);
+        pIn[i] = std::complex<int16_t>(int16_t(std::lround(x.real())), int16_t(std::lround(x.imag())));
+    }
+    feeder.call("feedBuffer", buffIn);
+
+    //run the topology
+    {
+        Pothos::Topology topology;
+        topology.connect(feeder, 0, filter, 0);
+        topology.connect(filter, 0, collector, 0);
+        topology.commit();
+        POTHOS_TEST_TRUE(topology.waitInactive(0.01));
+    }
+
+    //average magnitude after the filters settle
+    Pothos::BufferChunk buffOut = collector.call("getBuffer");
+    POTHOS_TEST_EQUAL(buffOut.elements(), numOut);
+    auto pOut = buffOut.as<const std::complex<int16_t> *>();
+    double sum = 0.0;
+    for (size_t i = numOut/4; i < numOut; i++)
+    {
+        sum += std::abs(std::complex<double>(pOut[i].real(), pOut[i].imag()));
+    }
+    return sum/(numOut-numOut/4);
+}
+
+POTHOS_TEST_BLOCK("/comms/tests", test_cic_compensation)
+{
+    for (size_t diffDelay = 1; diffDelay <= 2; diffDelay++)
+    {
+        //the compensated pass band is flat up to near the cutoff,
+        //and the uncompensated response has a noticeable droop
+        const double freq = 0.8*0.2;
+        const double dc = cicToneGetMagnitude(diffDelay, 41, 0.0);
+        const double comp = cicToneGetMagnitude(diffDelay, 41, freq);
+        const double droop = cicToneGetMagnitude(diffDelay, 0, freq);
+        std::cout << "CIC diffDelay " << diffDelay << " DC " << dc
+            << " compensated " << comp << " uncompensated " << droop << std::endl;
+        POTHOS_TEST_CLOSE(comp/dc, 1.0, 0.03);
+        POTHOS_TEST_TRUE(droop/dc < 0.9);
+    }
+}
@@ -5,6 +5,11 @@
 #include <Pothos/Framework.hpp>
 #include <Pothos/Proxy.hpp>
 #include <cmath> //fabs
+#include <complex>
+#include <cstdint>
+#include <vector>
+#include <string>
+#include <algorithm> //copy
 #include <iostream>
 
 static double filterToneGetRMS(
@@ -80,3 +85,558 @@ POTHOS_TEST_BLOCK("/comms/tests", test_fir_filter)
         }
     }
 }
+
+template <typename Type>
+static void testFIRFilterVector(const size_t dimension)
+{
+    const Pothos::DType dtype(typeid(Type), dimension);
+    std::cout << "Testing FIR filter on vector type " << dtype.toString() << " x " << dimension << std::endl;
+
+    //integer taps and inputs so that fixed point results are exact
+    const std::vector<double> taps = {1.0, -2.0, 3.0, 1.0};
+    const size_t K = taps.size();
+    const size_t numElems = 100;
+
+    auto feeder = Pothos::BlockRegistry::make("/blocks/feeder_source", dtype);
+    auto filter = Pothos::BlockRegistry::make("/comms/fir_filter", dtype, "REAL");
+    filter.call("setTaps", taps);
+    auto collector = Pothos::BlockRegistry::make("/blocks/collector_sink", dtype);
+
+    //each lane gets a different sequence
+    auto buffIn = Pothos::BufferChunk(dtype, numElems);
+    auto pIn = buffIn.as<Type *>();
+    for (size_t i = 0; i < numElems; i++)
+    {
+        for (size_t d = 0; d < dimension; d++)
+        {
+            pIn[i*dimension+d] = Type(int((i*(d+3))%17) - 8);
+        }
+    }
+    feeder.call("feedBuffer", buffIn);
+
+    //run the topology
+    {
+        Pothos::Topology topology;
+        topology.connect(feeder, 0, filter, 0);
+        topology.connect(filter, 0, collector, 0);
+        topology.commit();
+        POTHOS_TEST_TRUE(topology.waitInactive(0.01));
+    }
+
+    //every lane is filtered separately with the same taps,
+    //the first output is the first element with a full history
+    Pothos::BufferChunk buffOut = collector.call("getBuffer");
+    POTHOS_TEST_EQUAL(buffOut.elements(), numElems-(K-1));
+    auto pOut = buffOut.as<const Type *>();
+    for (size_t n = 0; n < buffOut.elements(); n++)
+    {
+        for (size_t d = 0; d < dimension; d++)
+        {
+            Type expected(0);
+            for (size_t k = 0; k < K; k++)
+            {
+                expected += Type(taps[k])*pIn[(n+K-1-k)*dimension+d];
+            }
+            POTHOS_TEST_EQUAL(pOut[n*dimension+d], expected);
+        }
+    }
+}
+
+POTHOS_TEST_BLOCK("/comms/tests", test_fir_filter_vector)
+{
+    testFIRFilterVector<float>(3);
+    testFIRFilterVector<double>(8);
+    testFIRFilterVector<std::complex<float>>(5);
+    testFIRFilterVector<int16_t>(4);
+    testFIRFilterVector<std::complex<int16_t>>(37);
+}
+
+template <typename Type>
+static void testFIRFilterRealComplex(const size_t decim)
+{
+    typedef std::complex<Type> OutType;
+    const Pothos::DType dtype(typeid(Type));
+    std::cout << "Testing FIR filter on real type " << dtype.toString() << " with complex taps, decim " << decim << std::endl;
+
+    //integer taps and inputs so that fixed point results are exact
+    const std::vector<std::complex<double>> taps = {{1.0, 0.0}, {-2.0, 1.0}, {3.0, -1.0}, {0.0, 2.0}, {1.0, 1.0}};
+    const size_t K = taps.size();
+    const size_t numElems = 100;
+
+    auto feeder = Pothos::BlockRegistry::make("/blocks/feeder_source", dtype);
+    auto filter = Pothos::BlockRegistry::make("/comms/fir_filter", dtype, "COMPLEX");
+    filter.call("setTaps", taps);
+    filter.call("setDecimation", decim);
+    auto collector = Pothos::BlockRegistry::make("/blocks/collector_sink", Pothos::DType(typeid(OutType)));
+
+    auto buffIn = Pothos::BufferChunk(dtype, numElems);
+    auto pIn = buffIn.as<Type *>();
+    for (size_t i = 0; i < numElems; i++) pIn[i] = Type(int((i*7)%13) - 6);
+    feeder.call("feedBuffer", buffIn);
+
+    //run the topology
+    {
+        Pothos::Topology topology;
+        topology.connect(feeder, 0, filter, 0);
+        topology.connect(filter, 0, collector, 0);
+        topology.commit();
+        POTHOS_TEST_TRUE(topology.waitInactive(0.01));
+    }
+
+    //the output is complex, and every decim-th output is kept
+    Pothos::BufferChunk buffOut = collector.call("getBuffer");
+    POTHOS_TEST_EQUAL(buffOut.elements(), (numElems-(K-1))/decim);
+    auto pOut = buffOut.as<const OutType *>();
+    for (size_t n = 0; n < buffOut.elements(); n++)
+    {
+        const size_t i = n*decim + decim-1;
+        OutType expected(0);
+        for (size_t k = 0; k < K; k++)
+        {
+            expected += OutType(Type(taps[k].real()), Type(taps[k].imag()))*pIn[i+K-1-k];
+        }
+        POTHOS_TEST_EQUAL(pOut[n], expected);
+    }
+}
+
+POTHOS_TEST_BLOCK("/comms/tests", test_fir_filter_real_complex)
+{
+    for (size_t decim = 1; decim <= 2; decim++)
+    {
+        testFIRFilterRealComplex<float>(decim);
+        testFIRFilterRealComplex<double>(decim);
+        testFIRFilterRealComplex<int16_t>(decim);
+    }
+}
+
+static void testFIRFilterSparse(const size_t decim, const size_t interp)
+{
+    const Pothos::DType dtype("complex_int16");
+    std::cout << "Testing sparse FIR filter, decim " << decim << " interp " << interp << std::endl;
+
+    //a long channel model with a few non-zero taps
+    std::vector<double> taps(400, 0.0);
+    taps[0] = 1.0;
+    taps[37] = -2.0;
+    taps[150] = 3.0;
+    taps[399] = 1.0;
+
+    auto feeder = Pothos::BlockRegistry::make("/blocks/feeder_source", dtype);
+    auto sparse = Pothos::BlockRegistry::make("/comms/fir_filter", dtype, "REAL");
+    auto direct = Pothos::BlockRegistry::make("/comms/fir_filter", dtype, "REAL");
+    for (auto filter : {sparse, direct})
+    {
+        filter.call("setTaps", taps);
+        filter.call("setDecimation", decim);
+        filter.call("setInterpolation", interp);
+    }
+    sparse.call("setConvolution", "AUTO"); //detects the sparse taps
+    direct.call("setConvolution", "DIRECT");
+    auto sparseCollector = Pothos::BlockRegistry::make("/blocks/collector_sink", dtype);
+    auto directCollector = Pothos::BlockRegistry::make("/blocks/collector_sink", dtype);
+
+    auto buffIn = Pothos::BufferChunk(dtype, 2000);
+    auto pIn = buffIn.as<std::complex<int16_t> *>();
+    for (size_t i = 0; i < buffIn.elements(); i++)
+    {
+        pIn[i] = std::complex<int16_t>(int16_t((i*7)%13) - 6, int16_t((i*5)%11) - 5);
+    }
+    feeder.call("feedBuffer", buffIn);
+
+    //run the topology
+    {
+        Pothos::Topology topology;
+        topology.connect(feeder, 0, sparse, 0);
+        topology.connect(feeder, 0, direct, 0);
+        topology.connect(sparse, 0, sparseCollector, 0);
+        topology.connect(direct, 0, directCollector, 0);
+        topology.commit();
+        POTHOS_TEST_TRUE(topology.waitInactive(0.01));
+    }
+
+    //fixed point sums are exact, so both methods match
+    Pothos::BufferChunk sparseOut = sparseCollector.call("getBuffer");
+    Pothos::BufferChunk directOut = directCollector.call("getBuffer");
+    POTHOS_TEST_TRUE(directOut.elements() > 0);
+    POTHOS_TEST_EQUAL(sparseOut.elements(), directOut.elements());
+    auto pSparse = sparseOut.as<const std::complex<int16_t> *>();
+    auto pDirect = directOut.as<const std::complex<int16_t> *>();
+    for (size_t i = 0; i < sparseOut.elements(); i++)
+    {
+        POTHOS_TEST_EQUAL(pSparse[i], pDirect[i]);
+    }
+}
+
+POTHOS_TEST_BLOCK("/comms/tests", test_fir_filter_sparse)
+{
+    for (size_t decim = 1; decim <= 2; decim++)
+    {
+        for (size_t interp = 1; interp <= 3; interp++)
+        {
+            testFIRFilterSparse(decim, interp);
+        }
+    }
+}
+
+/***********************************************************************
+ * Direct form reference of the polyphase filter for integer test data:
+ * output m is at the upsampled index m*M+M-1 and uses the input
+ * history of K elements ending at index K-1+(m*M+M-1)/L.
+ **********************************************************************/
+template <typename Type>
+static std::complex<double> firToComplex(const Type &x)
+{
+    return std::complex<double>(double(x));
+}
+
+template <typename Type>
+static std::complex<double> firToComplex(const std::complex<Type> &x)
+{
+    return std::complex<double>(double(x.real()), double(x.imag()));
+}
+
+template <typename Type>
+static void firToType(const std::complex<double> &y, Type &out)
+{
+    out = Type(y.real());
+}
+
+template <typename Type>
+static void firToType(const std::complex<double> &y, std::complex<Type> &out)
+{
+    out = std::complex<Type>(Type(y.real()), Type(y.imag()));
+}
+
+template <typename OutType, typename InType, typename TapsType>
+static OutType firReference(const std::vector<TapsType> &taps, const InType *x, const size_t m, const size_t M, const size_t L)
+{
+    const size_t K = (taps.size()+L-1)/L;
+    const size_t u = m*M + M-1;
+    std::complex<double> y(0.0);
+    for (size_t k = 0; k < K; k++)
+    {
+        const size_t t = u%L + k*L;
+        if (t < taps.size()) y += firToComplex(taps[t])*firToComplex(x[K-1+u/L-k]);
+    }
+    OutType out;
+    firToType(y, out);
+    return out;
+}
+
+template <typename Type, typename TapsType>
+static void testFIRFilterFolded(const size_t numTaps, const int symmetry, const size_t interp)
+{
+    const Pothos::DType dtype(typeid(Type));
+    const bool complexTaps = not std::is_same<TapsType, double>::value;
+    std::cout << "Testing folded FIR filter on " << dtype.toString() << (complexTaps?" with complex taps, ":" with real taps, ")
+        << numTaps << " taps, symmetry " << symmetry << ", interp " << interp << std::endl;
+
+    //integer taps mirrored about the centre, long enough for the folded kernel,
+    //and the centre tap of an antisymmetric filter with an odd length is zero
+    std::vector<TapsType> taps(numTaps);
+    for (size_t n = 0; n < numTaps/2; n++)
+    {
+        firToType(std::complex<double>(int((n*7)%5) - 2, int((n*3)%5) - 2), taps[n]);
+        taps[numTaps-1-n] = taps[n]*double(symmetry);
+    }
+    if (numTaps%2 == 1) taps[numTaps/2] = TapsType((symmetry > 0)?2.0:0.0);
+    const size_t K = (numTaps+interp-1)/interp;
+
+    auto feeder = Pothos::BlockRegistry::make("/blocks/feeder_source", dtype);
+    auto filter = Pothos::BlockRegistry::make("/comms/fir_filter", dtype, complexTaps?"COMPLEX":"REAL");
+    filter.call("setTaps", taps);
+    filter.call("setInterpolation", interp);
+    filter.call("setConvolution", "DIRECT");
+    auto collector = Pothos::BlockRegistry::make("/blocks/collector_sink", dtype);
+
+    auto buffIn = Pothos::BufferChunk(dtype, 2000);
+    auto pIn = buffIn.as<Type *>();
+    for (size_t i = 0; i < buffIn.elements(); i++)
+    {
+        firToType(std::complex<double>(int((i*7)%13) - 6, int((i*5)%11) - 5), pIn[i]);
+    }
+    feeder.call("feedBuffer", buffIn);
+
+    //run the topology
+    {
+        Pothos::Topology topology;
+        topology.connect(feeder, 0, filter, 0);
+        topology.connect(filter, 0, collector, 0);
+        topology.commit();
+        POTHOS_TEST_TRUE(topology.waitInactive(0.01));
+    }
+
+    //fixed point sums are exact, so the folded sums match the reference
+    Pothos::BufferChunk buffOut = collector.call("getBuffer");
+    POTHOS_TEST_EQUAL(buffOut.elements(), (buffIn.elements()-(K-1))*interp);
+    auto pOut = buffOut.as<const Type *>();
+    for (size_t m = 0; m < buffOut.elements(); m++)
+    {
+        POTHOS_TEST_EQUAL(pOut[m], (firReference<Type>(taps, pIn, m, 1, interp)));
+    }
+}
+
+POTHOS_TEST_BLOCK("/comms/tests", test_fir_filter_folded)
+{
+    for (size_t interp = 1; interp <= 2; interp++)
+    {
+        for (const size_t numTaps : {600, 601})
+        {
+            for (const int symmetry : {1, -1})
+            {
+                testFIRFilterFolded<int16_t, double>(numTaps, symmetry, interp);
+                testFIRFilterFolded<std::complex<int16_t>, double>(numTaps, symmetry, interp);
+                testFIRFilterFolded<std::complex<int16_t>, std::complex<double>>(numTaps, symmetry, interp);
+            }
+        }
+    }
+}
+
+template <typename Type>
+static void testFIRFilterFFT(const size_t decim, const std::string &burstId)
+{
+    const Pothos::DType dtype(typeid(Type));
+    std::cout << "Testing FFT FIR filter on " << dtype.toString() << ", decim " << decim
+        << (burstId.empty()?"":", bursts with "+burstId) << std::endl;
+
+    //long enough to select the FFT method for every decimation
+    std::vector<double> taps(257);
+    for (size_t k = 0; k < taps.size(); k++) taps[k] = std::cos(0.1*k)/(1.0+0.05*k);
+
+    auto feeder = Pothos::BlockRegistry::make("/blocks/feeder_source", dtype);
+    auto fft = Pothos::BlockRegistry::make("/comms/fir_filter", dtype, "REAL");
+    auto direct = Pothos::BlockRegistry::make("/comms/fir_filter", dtype, "REAL");
+    for (auto filter : {fft, direct})
+    {
+        filter.call("setTaps", taps);
+        filter.call("setDecimation", decim);
+        if (burstId == "frameStart") filter.call("setFrameStartId", burstId);
+        if (burstId == "frameEnd") filter.call("setFrameEndId", burstId);
+    }
+    fft.call("setConvolution", "FFT");
+    direct.call("setConvolution", "DIRECT");
+    auto fftCollector = Pothos::BlockRegistry::make("/blocks/collector_sink", dtype);
+    auto directCollector = Pothos::BlockRegistry::make("/blocks/collector_sink", dtype);
+
+    //buffer sizes that leave a remainder shorter than a transform block
+    size_t total = 0;
+    for (const size_t numElems : {1234, 2000, 1767})
+    {
+        auto buffIn = Pothos::BufferChunk(dtype, numElems);
+        auto pIn = buffIn.as<Type *>();
+        for (size_t i = 0; i < numElems; i++)
+        {
+            const double t = double(total+i);
+            pIn[i] = Type(std::sin(0.03*t) + 0.5*std::cos(0.31*t), std::cos(0.07*t));
+        }
+        feeder.call("feedBuffer", buffIn);
+        total += numElems;
+    }
+
+    //bursts which are flushed with zeros at the end
+    const std::vector<size_t> bursts = {1300, 1000, 2701};
+    size_t index = 0;
+    for (const size_t length : bursts)
+    {
+        if (burstId == "frameStart") feeder.call("feedLabel", Pothos::Label(burstId, length, index));
+        if (burstId == "frameEnd") feeder.call("feedLabel", Pothos::Label(burstId, length, index+length-1));
+        index += length;
+    }
+
+    //run the topology
+    {
+        Pothos::Topology topology;
+        topology.connect(feeder, 0, fft, 0);
+        topology.connect(feeder, 0, direct, 0);
+        topology.connect(fft, 0, fftCollector, 0);
+        topology.connect(direct, 0, directCollector, 0);
+        topology.commit();
+        POTHOS_TEST_TRUE(topology.waitInactive(0.01));
+    }
+
+    //both methods produce the same outputs within the rounding of the transforms
+    Pothos::BufferChunk fftOut = fftCollector.call("getBuffer");
+    Pothos::BufferChunk directOut = directCollector.call("getBuffer");
+    if (burstId.empty()) POTHOS_TEST_EQUAL(directOut.elements(), (total-(taps.size()-1))/decim);
+    else
+    {
+        size_t numOut = 0;
+        for (const size_t length : bursts) numOut += length/decim;
+        POTHOS_TEST_EQUAL(directOut.elements(), numOut);
+    }
+    POTHOS_TEST_EQUAL(fftOut.elements(), directOut.elements());
+    double gain = 0.0;
+    for (const auto &tap : taps) gain += std::abs(tap);
+    const double tol = gain*((sizeof(Type) == sizeof(std::complex<float>))?1e-5:1e-12);
+    auto pFFT = fftOut.as<const Type *>();
+    auto pDirect = directOut.as<const Type *>();
+    for (size_t i = 0; i < fftOut.elements(); i++)
+    {
+        POTHOS_TEST_CLOSE(std::abs(pFFT[i]-pDirect[i]), 0.0, tol);
+    }
+}
+
+POTHOS_TEST_BLOCK("/comms/tests", test_fir_filter_fft)
+{
+    for (size_t decim = 1; decim <= 3; decim++)
+    {
+        for (const std::string burstId : {"", "frameStart", "frameEnd"})
+        {
+            testFIRFilterFFT<std::complex<float>>(decim, burstId);
+            testFIRFilterFFT<std::complex<double>>(decim, burstId);
+        }
+    }
+}
+
+static void testFIRFilterCrossfade(const std::string &change)
+{
+    std::cout << "Testing FIR filter crossfade with a change of " << change << std::endl;
+
+    const size_t crossfade = 8;
+    const std::vector<double> oldTaps = {1, 2, 3, -2, 1};
+    std::vector<double> newTaps = {-1, 4, 0, 2, 3};
+    if (change == "length") newTaps = {-1, 4, 0, 2, 3, 1, -2};
+    const size_t newDecim = (change == "decimation")?2:1;
+
+    auto feeder = Pothos::BlockRegistry::make("/blocks/feeder_source", "float64");
+    auto filter = Pothos::BlockRegistry::make("/comms/fir_filter", "float64", "REAL");
+    filter.call("setTaps", oldTaps);
+    filter.call("setCrossfade", crossfade);
+    filter.call("setConvolution", "DIRECT");
+    auto collector = Pothos::BlockRegistry::make("/blocks/collector_sink", "float64");
+
+    //integer input, so that both filters are exact
+    std::vector<double> x(200);
+    for (size_t i = 0; i < x.size(); i++) x[i] = double(int((i*7)%13) - 6);
+    auto feed = [&](const size_t offset, const size_t numElems)
+    {
+        auto buffIn = Pothos::BufferChunk("float64", numElems);
+        std::copy(x.begin()+offset, x.begin()+offset+numElems, buffIn.as<double *>());
+        feeder.call("feedBuffer", buffIn);
+    };
+
+    //the first half with the old taps, then the taps change mid-stream
+    size_t numOld = 0;
+    {
+        Pothos::Topology topology;
+        topology.connect(feeder, 0, filter, 0);
+        topology.connect(filter, 0, collector, 0);
+        feed(0, 100);
+        topology.commit();
+        POTHOS_TEST_TRUE(topology.waitInactive(0.01));
+        numOld = collector.call<Pothos::BufferChunk>("getBuffer").elements();
+        POTHOS_TEST_EQUAL(numOld, 100-(oldTaps.size()-1));
+
+        if (change == "decimation") filter.call("setDecimation", newDecim);
+        else filter.call("setTaps", newTaps);
+        feed(100, 100);
+        POTHOS_TEST_TRUE(topology.waitInactive(0.01));
+    }
+
+    //a change of length or decimation takes effect immediately,
+    //otherwise the first outputs are a linear mix from the old filter to the new
+    const std::vector<double> &taps = (change == "decimation")?oldTaps:newTaps;
+    const bool fade = change == "taps";
+    Pothos::BufferChunk buffOut = collector.call("getBuffer");
+    POTHOS_TEST_EQUAL(buffOut.elements(), numOld + (x.size()-numOld-(taps.size()-1))/newDecim);
+    auto pOut = buffOut.as<const double *>();
+    for (size_t m = 0; m < buffOut.elements(); m++)
+    {
+        if (m < numOld)
+        {
+            POTHOS_TEST_EQUAL(pOut[m], (firReference<double>(oldTaps, x.data(), m, 1, 1)));
+            continue;
+        }
+        const size_t f = m - numOld;
+        const double y = firReference<double>(taps, x.data()+numOld, f, newDecim, 1);
+        if (not fade or f >= crossfade) POTHOS_TEST_EQUAL(pOut[m], y);
+        else
+        {
+            const double w = double(f+1)/(crossfade+1);
+            const double y_old = firReference<double>(oldTaps, x.data(), m, 1, 1);
+            POTHOS_TEST_CLOSE(pOut[m], y_old + (y - y_old)*w, 1e-9);
+        }
+    }
+}
+
+POTHOS_TEST_BLOCK("/comms/tests", test_fir_filter_crossfade)
+{
+    testFIRFilterCrossfade("taps");
+    testFIRFilterCrossfade("length");
+    testFIRFilterCrossfade("decimation");
+}
+
+static void testFIRFilterFlush(const size_t decim)
+{
+    std::cout << "Testing FIR filter burst flush, decim " << decim << std::endl;
+
+    //the taps grow from 8 to 40 between two groups of bursts
+    std::vector<double> taps0(8), taps1(40);
+    for (size_t k = 0; k < taps0.size(); k++) taps0[k] = double(int((k*5)%7) - 3);
+    for (size_t k = 0; k < taps1.size(); k++) taps1[k] = double(int((k*3)%11) - 5);
+
+    auto feeder = Pothos::BlockRegistry::make("/blocks/feeder_source", "float64");
+    auto filter = Pothos::BlockRegistry::make("/comms/fir_filter", "float64", "REAL");
+    filter.call("setTaps", taps0);
+    filter.call("setDecimation", decim);
+    filter.call("setConvolution", "DIRECT");
+    filter.call("setFrameStartId", "frameStart");
+    auto collector = Pothos::BlockRegistry::make("/blocks/collector_sink", "float64");
+
+    //bursts of integer values including lengths shorter than the taps,
+    //the first burst after the change is shorter than the new taps
+    const std::vector<size_t> bursts0 = {300, 3, 7, 51};
+    const std::vector<size_t> bursts1 = {20, 101};
+    std::vector<std::vector<double>> bursts;
+    size_t index = 0;
+    auto feed = [&](const std::vector<size_t> &lengths)
+    {
+        for (const size_t length : lengths)
+        {
+            auto buffIn = Pothos::BufferChunk("float64", length);
+            auto pIn = buffIn.as<double *>();
+            for (size_t i = 0; i < length; i++) pIn[i] = double(int(((index+i)*7)%13) - 6);
+            bursts.emplace_back(pIn, pIn+length);
+            feeder.call("feedBuffer", buffIn);
+            feeder.call("feedLabel", Pothos::Label("frameStart", length, index));
+            index += length;
+        }
+    };
+
+    {
+        Pothos::Topology topology;
+        topology.connect(feeder, 0, filter, 0);
+        topology.connect(filter, 0, collector, 0);
+        feed(bursts0);
+        topology.commit();
+        POTHOS_TEST_TRUE(topology.waitInactive(0.01));
+        filter.call("setTaps", taps1);
+        feed(bursts1);
+        POTHOS_TEST_TRUE(topology.waitInactive(0.01));
+    }
+
+    //each burst is filtered as if followed by zeros,
+    //and produces one output per decimation of its length
+    Pothos::BufferChunk buffOut = collector.call("getBuffer");
+    auto pOut = buffOut.as<const double *>();
+    size_t numOut = 0;
+    for (size_t b = 0; b < bursts.size(); b++)
+    {
+        const auto &taps = (b < bursts0.size())?taps0:taps1;
+        std::vector<double> x(bursts[b]);
+        x.resize(x.size()+taps.size()-1, 0.0);
+        for (size_t m = 0; m < bursts[b].size()/decim; m++)
+        {
+            POTHOS_TEST_TRUE(numOut < buffOut.elements());
+            POTHOS_TEST_EQUAL(pOut[numOut++], (firReference<double>(taps, x.data(), m, decim, 1)));
+        }
+    }
+    POTHOS_TEST_EQUAL(buffOut.elements(), numOut);
+}
+
+POTHOS_TEST_BLOCK("/comms/tests", test_fir_filter_flush)
+{
+    testFIRFilterFlush(1);
+    testFIRFilterFlush(2);
+    testFIRFilterFlush(3);
+}
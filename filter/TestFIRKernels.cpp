@@ -0,0 +1,168 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#include "FIRKernels.hpp"
+#include <Pothos/Testing.hpp>
+#include <complex>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <iostream>
+
+/***********************************************************************
+ * Integer valued taps and inputs, small enough that every partial sum
+ * is exact in the floating point types, so all kernels match exactly.
+ **********************************************************************/
+template <typename Type>
+static Type kernelTestValue(const int re, const int, Type *)
+{
+    return Type(re);
+}
+
+template <typename Type>
+static std::complex<Type> kernelTestValue(const int re, const int im, std::complex<Type> *)
+{
+    return std::complex<Type>(Type(re), Type(im));
+}
+
+template <typename Type>
+static void kernelTestFill(std::vector<Type> &v, const size_t seed)
+{
+    for (size_t i = 0; i < v.size(); i++)
+    {
+        const int re = int(((i+seed)*7)%9) - 4;
+        const int im = int(((i+seed)*5)%7) - 3;
+        v[i] = kernelTestValue(re, im, static_cast<Type *>(nullptr));
+    }
+}
+
+template <typename QType, typename QTapsType, typename InType>
+struct FIRKernelsTester
+{
+    typedef FIRKernels<QType, QTapsType, InType> Kernels;
+    typedef typename Kernels::TapsScalar TapsScalar;
+    typedef typename Kernels::DotFcn DotFcn;
+    typedef std::vector<std::pair<std::string, DotFcn>> KernelList;
+
+    //! Every vector kernel that this CPU supports for the given symmetry
+    template <int Sign>
+    static KernelList supported(void)
+    {
+        KernelList kernels;
+        #ifdef FIR_KERNELS_SIMD
+        kernels.emplace_back("Vec128", &Kernels::template dotVec128<Sign>);
+        #endif //FIR_KERNELS_SIMD
+        #ifdef FIR_KERNELS_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2") and __builtin_cpu_supports("fma"))
+            kernels.emplace_back("AVX2", &Kernels::template dotAVX2<Sign>);
+        if (__builtin_cpu_supports("avx512f"))
+            kernels.emplace_back("AVX512", &Kernels::template dotAVX512<Sign>);
+        #endif //FIR_KERNELS_X86
+        return kernels;
+    }
+
+    //! Compare each kernel against the scalar loop for K taps with the given symmetry
+    static void check(const KernelList &kernels, const size_t K, const int symmetry)
+    {
+        //time-reversed taps with the requested symmetry
+        std::vector<QTapsType> taps(K);
+        kernelTestFill(taps, K);
+        for (size_t k = 0; k < K/2; k++) taps[K-1-k] = (symmetry < 0)?-taps[k]:taps[k];
+        if (symmetry < 0 and K%2 == 1) taps[K/2] = QTapsType(0);
+        if (symmetry != 0) POTHOS_TEST_EQUAL(Kernels::symmetry(taps.data(), K), symmetry);
+
+        std::vector<TapsScalar> packed(Kernels::packedSize(K));
+        Kernels::pack(taps.data(), K, packed.data());
+
+        //an odd offset into the input checks the unaligned loads
+        std::vector<InType> input(K+1);
+        kernelTestFill(input, 3);
+        const InType *x = input.data()+1;
+
+        QType expected;
+        Kernels::dotScalar(packed.data(), x, K, expected);
+        for (const auto &kernel : kernels)
+        {
+            QType y;
+            kernel.second(packed.data(), x, K, y);
+            if (y == expected) continue;
+            std::cerr << kernel.first << " K=" << K << " symmetry=" << symmetry << std::endl;
+            POTHOS_TEST_TRUE(y == expected);
+        }
+    }
+
+    #ifdef FIR_KERNELS_SIMD
+    //! The kernels compiled for exactly K taps in each table
+    template <size_t... N>
+    static KernelList fixed(const size_t K, FIRIndexes<N...>)
+    {
+        KernelList kernels;
+        static const DotFcn vec128[] = {&Kernels::template dotFixedVec128<N>...};
+        kernels.emplace_back("FixedVec128", vec128[K]);
+        #ifdef FIR_KERNELS_X86
+        static const DotFcn avx2[] = {&Kernels::template dotFixedAVX2<N>...};
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2") and __builtin_cpu_supports("fma"))
+            kernels.emplace_back("FixedAVX2", avx2[K]);
+        #endif //FIR_KERNELS_X86
+        return kernels;
+    }
+    #endif //FIR_KERNELS_SIMD
+
+    //! Sweep the short lengths across the fixed kernels and the first general one
+    static void testShort(const std::string &name)
+    {
+        std::cout << "Testing short FIR kernels for " << name << std::endl;
+        for (size_t K = 1; K <= FIR_KERNELS_FIXED_MAX_TAPS+1; K++)
+        {
+            KernelList kernels;
+            #ifdef FIR_KERNELS_SIMD
+            if (K <= FIR_KERNELS_FIXED_MAX_TAPS) kernels = fixed(K, typename FIRMakeIndexes<FIR_KERNELS_FIXED_MAX_TAPS+1>::type());
+            #endif //FIR_KERNELS_SIMD
+            const DotFcn selected = Kernels::dot(K);
+            if (selected != nullptr) kernels.emplace_back("Selected", selected);
+            check(kernels, K, 0);
+        }
+    }
+
+    static void test(const std::string &name)
+    {
+        std::cout << "Testing FIR kernels for " << name << std::endl;
+
+        //lengths with remainders for every vector width,
+        //up to taps that fill the 512-bit kernel several times
+        const std::vector<size_t> lengths = {1, 2, 3, 5, 7, 8, 13, 16, 31, 33, 63, 64, 100, 127, 255, 257, 300, 513, 1031};
+        const auto direct = supported<0>();
+        const auto symmetric = supported<1>();
+        const auto antisymmetric = supported<-1>();
+        for (const size_t K : lengths)
+        {
+            check(direct, K, 0);
+            if (K < 2) continue;
+            check(symmetric, K, 1);
+            check(antisymmetric, K, -1);
+        }
+    }
+};
+
+POTHOS_TEST_BLOCK("/comms/tests", test_fir_kernels)
+{
+    FIRKernelsTester<float, float, float>::test("real taps, real input, float");
+    FIRKernelsTester<double, double, double>::test("real taps, real input, double");
+    FIRKernelsTester<int32_t, int32_t, int16_t>::test("real taps, real input, int16");
+    FIRKernelsTester<std::complex<float>, float, std::complex<float>>::test("real taps, complex input, float");
+    FIRKernelsTester<std::complex<int32_t>, int32_t, std::complex<int16_t>>::test("real taps, complex input, int16");
+    FIRKernelsTester<std::complex<float>, std::complex<float>, std::complex<float>>::test("complex taps, complex input, float");
+    FIRKernelsTester<std::complex<double>, std::complex<double>, std::complex<double>>::test("complex taps, complex input, double");
+    FIRKernelsTester<std::complex<int32_t>, std::complex<int32_t>, std::complex<int16_t>>::test("complex taps, complex input, int16");
+    FIRKernelsTester<std::complex<float>, std::complex<float>, float>::test("complex taps, real input, float");
+    FIRKernelsTester<std::complex<int32_t>, std::complex<int32_t>, int16_t>::test("complex taps, real input, int16");
+}
+
+POTHOS_TEST_BLOCK("/comms/tests", test_fir_kernels_short)
+{
+    FIRKernelsTester<int32_t, int32_t, int16_t>::testShort("real taps, real input, int16");
+    FIRKernelsTester<std::complex<int32_t>, int32_t, std::complex<int16_t>>::testShort("real taps, complex input, int16");
+    FIRKernelsTester<std::complex<int32_t>, std::complex<int32_t>, std::complex<int16_t>>::testShort("complex taps, complex input, int16");
+    FIRKernelsTester<std::complex<int32_t>, std::complex<int32_t>, int16_t>::testShort("complex taps, real input, int16");
+}
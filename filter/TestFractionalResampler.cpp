@@ -0,0 +1,171 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#include <Pothos/Testing.hpp>
+#include <Pothos/Framework.hpp>
+#include <Pothos/Proxy.hpp>
+#include <complex>
+#include <cstdint>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <iostream>
+
+static const size_t resamplerTestTaps = 32; //taps per phase
+
+template <typename Type>
+static std::complex<Type> resamplerTestSample(const std::complex<double> &x, std::complex<Type> *)
+{
+    return std::complex<Type>(Type(x.real()), Type(x.imag()));
+}
+
+static std::complex<int16_t> resamplerTestSample(const std::complex<double> &x, std::complex<int16_t> *)
+{
+    return std::complex<int16_t>(int16_t(std::lround(x.real())), int16_t(std::lround(x.imag())));
+}
+
+/***********************************************************************
+ * Resample a complex tone of freq cycles per input element
+ * with optional labels, and return the output as complex double
+ **********************************************************************/
+template <typename Type>
+static std::vector<std::complex<double>> resampleTone(
+    const double amplitude,
+    const double freq,
+    const size_t numIn,
+    const double ratio,
+    const std::string &interp,
+    const std::vector<Pothos::Label> &labels,
+    std::vector<Pothos::Label> &outLabels)
+{
+    const Pothos::DType dtype(typeid(Type));
+    auto feeder = Pothos::BlockRegistry::make("/blocks/feeder_source", dtype);
+    auto resampler = Pothos::BlockRegistry::make("/comms/fractional_resampler", dtype);
+    resampler.call("setRatio", ratio);
+    resampler.call("setInterpolation", interp);
+    resampler.call("setNumTaps", resamplerTestTaps);
+    resampler.call("setRatioId", "ratio");
+    auto collector = Pothos::BlockRegistry::make("/blocks/collector_sink", dtype);
+
+    auto buffIn = Pothos::BufferChunk(dtype, numIn);
+    auto pIn = buffIn.as<Type *>();
+    for (size_t i = 0; i < numIn; i++)
+    {
+        pIn[i] = resamplerTestSample(std::polar(amplitude, 2*M_PI*freq*i), static_cast<Type *>(nullptr));
+    }
+    feeder.call("feedBuffer", buffIn);
+    for (const auto &label : labels) feeder.call("feedLabel", label);
+
+    //run the topology
+    {
+        Pothos::Topology topology;
+        topology.connect(feeder, 0, resampler, 0);
+        topology.connect(resampler, 0, collector, 0);
+        topology.commit();
+        POTHOS_TEST_TRUE(topology.waitInactive(0.01));
+    }
+
+    outLabels = collector.call<std::vector<Pothos::Label>>("getLabels");
+    Pothos::BufferChunk buffOut = collector.call("getBuffer");
+    auto pOut = buffOut.as<const Type *>();
+    std::vector<std::complex<double>> out;
+    for (size_t i = 0; i < buffOut.elements(); i++)
+    {
+        out.emplace_back(double(pOut[i].real()), double(pOut[i].imag()));
+    }
+    return out;
+}
+
+//the average phase step and magnitude of the tone over [begin, end)
+static void resamplerToneMeasure(
+    const std::vector<std::complex<double>> &y,
+    const size_t begin, const size_t end,
+    double &step, double &magnitude)
+{
+    std::complex<double> acc(0.0);
+    magnitude = 0.0;
+    for (size_t m = begin; m+1 < end; m++)
+    {
+        acc += y[m+1]*std::conj(y[m]);
+        magnitude += std::abs(y[m]);
+    }
+    step = std::arg(acc);
+    magnitude /= (end-begin-1);
+}
+
+template <typename Type>
+static void testFractionalResampler(const double ratio, const std::string &interp)
+{
+    const Pothos::DType dtype(typeid(Type));
+    std::cout << "Testing fractional resampler on " << dtype.toString() << ", ratio " << ratio << " " << interp << std::endl;
+
+    //the tone is in the pass band at both rates
+    const double amplitude = 8000;
+    const double freq = 0.05;
+    const size_t numIn = 4096;
+    std::vector<Pothos::Label> outLabels;
+    const auto y = resampleTone<Type>(amplitude, freq, numIn, ratio, interp, {}, outLabels);
+
+    //one output per 1/ratio inputs over the positions with a full filter history
+    const double expectedOut = (numIn-(resamplerTestTaps-1))*ratio;
+    POTHOS_TEST_CLOSE(double(y.size()), expectedOut, 1.0);
+
+    //the tone frequency scales by the inverse ratio after the filter settles
+    double step, magnitude;
+    resamplerToneMeasure(y, y.size()/8, y.size(), step, magnitude);
+    POTHOS_TEST_CLOSE(step, 2*M_PI*freq/ratio, 1e-3);
+    POTHOS_TEST_CLOSE(magnitude/amplitude, 1.0, 0.01);
+}
+
+POTHOS_TEST_BLOCK("/comms/tests", test_fractional_resampler)
+{
+    for (const double ratio : {0.5, 1.000137, 48000/44100.5, 1.7})
+    {
+        for (const std::string interp : {"LINEAR", "CUBIC"})
+        {
+            testFractionalResampler<std::complex<double>>(ratio, interp);
+            testFractionalResampler<std::complex<int16_t>>(ratio, interp);
+        }
+    }
+}
+
+template <typename Type>
+static void testFractionalResamplerLabel(void)
+{
+    const Pothos::DType dtype(typeid(Type));
+    std::cout << "Testing fractional resampler ratio label on " << dtype.toString() << std::endl;
+
+    //a ratio label which is not a double is ignored,
+    //the ratio changes from 1 to 0.5 at the double label
+    const double amplitude = 8000;
+    const double freq = 0.05;
+    const size_t numIn = 4096, labelIndex = 1000;
+    const std::vector<Pothos::Label> labels = {
+        Pothos::Label("ratio", int(2), 500),
+        Pothos::Label("ratio", 0.5, labelIndex)};
+    std::vector<Pothos::Label> outLabels;
+    const auto y = resampleTone<Type>(amplitude, freq, numIn, 1.0, "CUBIC", labels, outLabels);
+
+    //one output per input up to the label, then one per 2 inputs
+    const size_t numAfter = numIn-(resamplerTestTaps-1)-labelIndex;
+    POTHOS_TEST_EQUAL(y.size(), labelIndex+(numAfter+1)/2);
+    POTHOS_TEST_EQUAL(outLabels.size(), labels.size());
+    POTHOS_TEST_EQUAL(outLabels[0].index, 500);
+    POTHOS_TEST_EQUAL(outLabels[1].index, labelIndex);
+
+    //the phase step of the tone doubles at the labeled output
+    double step, magnitude;
+    resamplerToneMeasure(y, 100, labelIndex, step, magnitude);
+    POTHOS_TEST_CLOSE(step, 2*M_PI*freq, 1e-3);
+    resamplerToneMeasure(y, labelIndex-1, labelIndex+1, step, magnitude);
+    POTHOS_TEST_CLOSE(step, 2*M_PI*freq, 1e-3);
+    resamplerToneMeasure(y, labelIndex, y.size(), step, magnitude);
+    POTHOS_TEST_CLOSE(step, 2*M_PI*freq*2, 1e-3);
+    resamplerToneMeasure(y, labelIndex, labelIndex+2, step, magnitude);
+    POTHOS_TEST_CLOSE(step, 2*M_PI*freq*2, 1e-3);
+}
+
+POTHOS_TEST_BLOCK("/comms/tests", test_fractional_resampler_label)
+{
+    testFractionalResamplerLabel<std::complex<double>>();
+    testFractionalResamplerLabel<std::complex<int16_t>>();
+}
@@ -0,0 +1,200 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#include <Pothos/Testing.hpp>
+#include <Pothos/Framework.hpp>
+#include <Pothos/Proxy.hpp>
+#include <complex>
+#include <cstdint>
+#include <algorithm> //copy
+#include <string>
+#include <vector>
+#include <iostream>
+
+//half-band taps in multiples of 1/256, so that the sums of integer inputs are exact
+static const std::vector<double> halfbandTestTaps = {
+    3/256., 0, -19/256., 0, 80/256., 128/256., 80/256., 0, -19/256., 0, 3/256.};
+
+template <typename Type>
+static std::complex<Type> halfbandTestValue(const int re, const int im, std::complex<Type> *)
+{
+    return std::complex<Type>(Type(re), Type(im));
+}
+
+/***********************************************************************
+ * Run a block over the input and collect the output
+ **********************************************************************/
+template <typename Type>
+static std::vector<Type> halfbandTestRun(Pothos::Proxy filter, const std::vector<Type> &input)
+{
+    const Pothos::DType dtype(typeid(Type));
+    auto feeder = Pothos::BlockRegistry::make("/blocks/feeder_source", dtype);
+    auto collector = Pothos::BlockRegistry::make("/blocks/collector_sink", dtype);
+
+    auto buffIn = Pothos::BufferChunk(dtype, input.size());
+    std::copy(input.begin(), input.end(), buffIn.as<Type *>());
+    feeder.call("feedBuffer", buffIn);
+
+    {
+        Pothos::Topology topology;
+        topology.connect(feeder, 0, filter, 0);
+        topology.connect(filter, 0, collector, 0);
+        topology.commit();
+        POTHOS_TEST_TRUE(topology.waitInactive(0.01));
+    }
+
+    Pothos::BufferChunk buffOut = collector.call("getBuffer");
+    auto pOut = buffOut.as<const Type *>();
+    return std::vector<Type>(pOut, pOut+buffOut.elements());
+}
+
+/***********************************************************************
+ * One stage of the reference: the FIR filter with the full taps,
+ * the input is preceded by zeros for the initial filter history,
+ * like the zero history of the half-band filter
+ **********************************************************************/
+template <typename Type>
+static std::vector<Type> halfbandTestReference(const std::vector<Type> &input, const bool interp)
+{
+    const Pothos::DType dtype(typeid(Type));
+    auto filter = Pothos::BlockRegistry::make("/comms/fir_filter", dtype, "REAL");
+    filter.call("setConvolution", "DIRECT");
+    std::vector<double> taps(halfbandTestTaps);
+    if (interp) for (auto &tap : taps) tap *= 2; //unity gain for the zero-stuffed input
+    filter.call("setTaps", taps);
+    if (interp) filter.call("setInterpolation", 2);
+    else filter.call("setDecimation", 2);
+
+    const size_t K = interp?(taps.size()+1)/2:taps.size();
+    std::vector<Type> padded(K-1, Type(0));
+    padded.insert(padded.end(), input.begin(), input.end());
+    return halfbandTestRun(filter, padded);
+}
+
+template <typename Type>
+static void testHalfbandFilter(const std::string &mode, const size_t stages)
+{
+    const Pothos::DType dtype(typeid(Type));
+    std::cout << "Testing half-band filter on " << dtype.toString() << ", " << mode << " stages " << stages << std::endl;
+
+    std::vector<Type> input(1024);
+    for (size_t i = 0; i < input.size(); i++)
+    {
+        input[i] = halfbandTestValue(int((i*37)%201) - 100, int((i*11)%151) - 75, static_cast<Type *>(nullptr));
+    }
+
+    auto filter = Pothos::BlockRegistry::make("/comms/halfband_filter", dtype);
+    filter.call("setMode", mode);
+    filter.call("setStages", stages);
+    filter.call("setTaps", halfbandTestTaps);
+    const auto output = halfbandTestRun(filter, input);
+
+    const bool interp = mode == "INTERPOLATE";
+    auto expected = input;
+    for (size_t i = 0; i < stages; i++) expected = halfbandTestReference(expected, interp);
+
+    //each stage changes the rate by 2, and the output is exact
+    const size_t factor = size_t(1) << stages;
+    POTHOS_TEST_EQUAL(output.size(), interp?(input.size()*factor):(input.size()/factor));
+    POTHOS_TEST_EQUAL(output.size(), expected.size());
+    for (size_t i = 0; i < output.size(); i++)
+    {
+        POTHOS_TEST_EQUAL(output[i], expected[i]);
+    }
+}
+
+POTHOS_TEST_BLOCK("/comms/tests", test_halfband_filter)
+{
+    for (const std::string mode : {"DECIMATE", "INTERPOLATE"})
+    {
+        for (size_t stages = 1; stages <= 2; stages++)
+        {
+            testHalfbandFilter<std::complex<double>>(mode, stages);
+            testHalfbandFilter<std::complex<int16_t>>(mode, stages);
+        }
+    }
+}
+
+/***********************************************************************
+ * Each burst is filtered from a zero history and followed by zeros
+ * for the entire tail of each stage, like the reference stage
+ * on the burst with K-1 zeros and, to decimate, one more for an even length
+ **********************************************************************/
+static void testHalfbandFilterFlush(const std::string &mode, const size_t stages)
+{
+    std::cout << "Testing half-band filter burst flush, " << mode << " stages " << stages << std::endl;
+    typedef std::complex<double> Type;
+    const bool interp = mode == "INTERPOLATE";
+
+    auto feeder = Pothos::BlockRegistry::make("/blocks/feeder_source", "complex_float64");
+    auto filter = Pothos::BlockRegistry::make("/comms/halfband_filter", "complex_float64");
+    filter.call("setMode", mode);
+    filter.call("setStages", stages);
+    filter.call("setTaps", halfbandTestTaps);
+    filter.call("setFrameStartId", "frameStart");
+    auto collector = Pothos::BlockRegistry::make("/blocks/collector_sink", "complex_float64");
+
+    //bursts including odd lengths and lengths shorter than the taps,
+    //the longer bursts flush more than the 8 KiB output buffers (512 elements),
+    //which leaves the tail for the flush in a later call, and some of those
+    //bursts fit in the output space when filtered without the flush
+    const std::vector<size_t> lengths = {300, 3, 7, 1020, 51, 255, 1, 2040, 126, 2, 18};
+    std::vector<std::vector<Type>> bursts;
+    size_t index = 0;
+    for (const size_t length : lengths)
+    {
+        std::vector<Type> burst(length);
+        for (size_t i = 0; i < length; i++)
+        {
+            burst[i] = halfbandTestValue(int(((index+i)*37)%201) - 100, int(((index+i)*11)%151) - 75, static_cast<Type *>(nullptr));
+        }
+        auto buffIn = Pothos::BufferChunk("complex_float64", length);
+        std::copy(burst.begin(), burst.end(), buffIn.as<Type *>());
+        feeder.call("feedBuffer", buffIn);
+        feeder.call("feedLabel", Pothos::Label("frameStart", length, index));
+        bursts.push_back(burst);
+        index += length;
+    }
+
+    {
+        Pothos::Topology topology;
+        topology.connect(feeder, 0, filter, 0);
+        topology.connect(filter, 0, collector, 0);
+        topology.commit();
+        POTHOS_TEST_TRUE(topology.waitInactive(0.01));
+    }
+
+    std::vector<Type> expected;
+    const size_t K = interp?(halfbandTestTaps.size()+1)/2:halfbandTestTaps.size();
+    for (auto burst : bursts)
+    {
+        for (size_t i = 0; i < stages; i++)
+        {
+            //the number of outputs in the block documentation
+            const size_t L = burst.size(), T = halfbandTestTaps.size();
+            const size_t numZeros = interp?(K-1):(K-1+(burst.size()+K-1)%2);
+            burst.resize(burst.size()+numZeros, Type(0));
+            burst = halfbandTestReference(burst, interp);
+            POTHOS_TEST_EQUAL(burst.size(), interp?(2*L+T-1):((L+T)/2));
+        }
+        expected.insert(expected.end(), burst.begin(), burst.end());
+    }
+
+    Pothos::BufferChunk buffOut = collector.call("getBuffer");
+    auto pOut = buffOut.as<const Type *>();
+    POTHOS_TEST_EQUAL(buffOut.elements(), expected.size());
+    for (size_t i = 0; i < expected.size(); i++)
+    {
+        POTHOS_TEST_EQUAL(pOut[i], expected[i]);
+    }
+}
+
+POTHOS_TEST_BLOCK("/comms/tests", test_halfband_filter_flush)
+{
+    for (const std::string mode : {"DECIMATE", "INTERPOLATE"})
+    {
+        for (size_t stages = 1; stages <= 2; stages++)
+        {
+            testHalfbandFilterFlush(mode, stages);
+        }
+    }
+}
@@ -0,0 +1,163 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#include <Pothos/Testing.hpp>
+#include <Pothos/Framework.hpp>
+#include <Pothos/Proxy.hpp>
+#include <complex>
+#include <cmath>
+#include <algorithm> //min, copy
+#include <string>
+#include <vector>
+#include <iostream>
+
+//the channel mixer exp(-j*2*pi*n/N), exact for quarter turns
+static std::complex<double> pfbTestMixer(const size_t n, const size_t N)
+{
+    if ((4*n)%N == 0)
+    {
+        static const std::complex<double> quarters[4] = {{1, 0}, {0, -1}, {-1, 0}, {0, 1}};
+        return quarters[((4*n)/N)%4];
+    }
+    return std::polar(1.0, -2*M_PI*double(n)/double(N));
+}
+
+/***********************************************************************
+ * Run a block with one input and the given number of outputs
+ **********************************************************************/
+template <typename Type>
+static std::vector<std::vector<Type>> pfbTestRun(
+    Pothos::Proxy block,
+    const size_t numOutputs,
+    const std::vector<Type> &input,
+    const std::vector<size_t> &chunks,
+    const std::vector<Pothos::Label> &labels,
+    std::vector<std::vector<Pothos::Label>> &outLabels)
+{
+    const Pothos::DType dtype(typeid(Type));
+    auto feeder = Pothos::BlockRegistry::make("/blocks/feeder_source", dtype);
+    for (size_t offset = 0, i = 0; offset < input.size(); i++)
+    {
+        const size_t numElems = std::min(chunks[i%chunks.size()], input.size()-offset);
+        auto buffIn = Pothos::BufferChunk(dtype, numElems);
+        std::copy(input.begin()+offset, input.begin()+offset+numElems, buffIn.as<Type *>());
+        feeder.call("feedBuffer", buffIn);
+        offset += numElems;
+    }
+    for (const auto &label : labels) feeder.call("feedLabel", label);
+
+    std::vector<Pothos::Proxy> collectors;
+    for (size_t c = 0; c < numOutputs; c++)
+    {
+        collectors.push_back(Pothos::BlockRegistry::make("/blocks/collector_sink", dtype));
+    }
+
+    {
+        Pothos::Topology topology;
+        topology.connect(feeder, 0, block, 0);
+        for (size_t c = 0; c < numOutputs; c++) topology.connect(block, c, collectors[c], 0);
+        topology.commit();
+        POTHOS_TEST_TRUE(topology.waitInactive(0.01));
+    }
+
+    std::vector<std::vector<Type>> outputs;
+    outLabels.clear();
+    for (auto collector : collectors)
+    {
+        Pothos::BufferChunk buffOut = collector.call("getBuffer");
+        auto pOut = buffOut.as<const Type *>();
+        outputs.emplace_back(pOut, pOut+buffOut.elements());
+        outLabels.push_back(collector.call<std::vector<Pothos::Label>>("getLabels"));
+    }
+    return outputs;
+}
+
+/***********************************************************************
+ * Each channel is the input mixed down by the channel frequency,
+ * then the FIR filter with the prototype taps and decimation N,
+ * with K-1 zeros before the input for the zero history of the branches
+ **********************************************************************/
+template <typename Type>
+static void testPFBChannelizer(const size_t N, const std::vector<double> &taps, const double tol)
+{
+    const Pothos::DType dtype(typeid(Type));
+    std::cout << "Testing PFB channelizer on " << dtype.toString()
+        << ", " << N << " channels, " << taps.size() << " taps" << std::endl;
+
+    //integer valued inputs, which are not a whole number of blocks
+    //and are fed in chunks which split the blocks
+    const size_t numIn = 1024*N+N/2;
+    std::vector<Type> input(numIn);
+    for (size_t n = 0; n < numIn; n++)
+    {
+        input[n] = Type(double(int((n*37)%201) - 100), double(int((n*11)%151) - 75));
+    }
+    const std::vector<size_t> chunks = {997, 61, 256, 3};
+
+    //the rate changes on every port, the other labels move to the decimated index
+    const double rate = 1e6;
+    const std::vector<Pothos::Label> labels = {
+        Pothos::Label("rxRate", rate, 0),
+        Pothos::Label("myLabel", 42, 10*N+1)};
+
+    auto channelizer = Pothos::BlockRegistry::make("/comms/pfb_channelizer", dtype, N);
+    channelizer.call("setTaps", taps);
+    std::vector<std::vector<Pothos::Label>> outLabels;
+    const auto outputs = pfbTestRun(channelizer, N, input, chunks, labels, outLabels);
+    POTHOS_TEST_EQUAL(outputs.size(), N);
+
+    for (size_t c = 0; c < N; c++)
+    {
+        std::vector<Type> mixed(taps.size()-1, Type(0));
+        for (size_t n = 0; n < numIn; n++)
+        {
+            const auto y = std::complex<double>(input[n])*pfbTestMixer((c*n)%N, N);
+            mixed.push_back(Type(y.real(), y.imag()));
+        }
+        auto filter = Pothos::BlockRegistry::make("/comms/fir_filter", dtype, "REAL");
+        filter.call("setTaps", taps);
+        filter.call("setDecimation", N);
+        filter.call("setConvolution", "DIRECT");
+        std::vector<std::vector<Pothos::Label>> refLabels;
+        const auto expected = pfbTestRun(filter, 1, mixed, {mixed.size()}, {}, refLabels).at(0);
+
+        //one output per block of N inputs
+        const auto &output = outputs[c];
+        POTHOS_TEST_EQUAL(output.size(), numIn/N);
+        POTHOS_TEST_EQUAL(output.size(), expected.size());
+        for (size_t m = 0; m < output.size(); m++)
+        {
+            if (tol == 0.0) POTHOS_TEST_EQUAL(output[m], expected[m]);
+            else POTHOS_TEST_CLOSE(std::abs(std::complex<double>(output[m]-expected[m])), 0.0, tol);
+        }
+
+        const auto &portLabels = outLabels[c];
+        POTHOS_TEST_EQUAL(portLabels.size(), labels.size());
+        POTHOS_TEST_EQUAL(portLabels[0].id, "rxRate");
+        POTHOS_TEST_EQUAL(portLabels[0].index, 0);
+        POTHOS_TEST_EQUAL(portLabels[0].data.template convert<double>(), rate/N);
+        POTHOS_TEST_EQUAL(portLabels[1].id, "myLabel");
+        POTHOS_TEST_EQUAL(portLabels[1].index, (10*N+1)/N);
+    }
+}
+
+POTHOS_TEST_BLOCK("/comms/tests", test_pfb_channelizer)
+{
+    //integer valued taps, longer and shorter than the number of channels
+    std::vector<double> taps(37);
+    for (size_t k = 0; k < taps.size(); k++) taps[k] = double(int((k*5)%11) - 5);
+    const std::vector<double> shortTaps = {2, -1, 3};
+
+    //the FFT and the mixer are exact for 1, 2, and 4 channels
+    for (const size_t N : {1, 2, 4})
+    {
+        testPFBChannelizer<std::complex<double>>(N, taps, 0.0);
+        testPFBChannelizer<std::complex<double>>(N, shortTaps, 0.0);
+        testPFBChannelizer<std::complex<float>>(N, taps, 0.0);
+    }
+    for (const size_t N : {5, 8})
+    {
+        testPFBChannelizer<std::complex<double>>(N, taps, 1e-9);
+        testPFBChannelizer<std::complex<double>>(N, shortTaps, 1e-9);
+        testPFBChannelizer<std::complex<float>>(N, taps, 0.05);
+    }
+}
@@ -0,0 +1,62 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#include "FFTPlanCache.hpp"
+#include <map>
+#include <mutex>
+#include <tuple>
+
+typedef std::tuple<std::string, size_t, bool> FFTPlanKey;
+
+static std::mutex &getFFTPlanMutex(void)
+{
+    static std::mutex mutex;
+    return mutex;
+}
+
+static std::map<FFTPlanKey, std::weak_ptr<void>> &getFFTPlans(void)
+{
+    static std::map<FFTPlanKey, std::weak_ptr<void>> plans;
+    return plans;
+}
+
+std::shared_ptr<void> getFFTPlan(
+    const std::string &planType,
+    const size_t numBins,
+    const bool inverse,
+    const std::function<std::shared_ptr<void>(void)> &make)
+{
+    const FFTPlanKey key(planType, numBins, inverse);
+    std::lock_guard<std::mutex> lock(getFFTPlanMutex());
+    auto &plans = getFFTPlans();
+    auto it = plans.find(key);
+    if (it != plans.end())
+    {
+        auto plan = it->second.lock();
+        if (plan) return plan;
+    }
+
+    //The users share a handle which removes the entry with the last user,
+    //so that no expired entry outlives the module that made the plan.
+    //The entry is only removed when it was not replaced by a new plan
+    //of the same key, made after the last user released the handle.
+    std::shared_ptr<void> made = make();
+    void *ptr = made.get();
+    std::shared_ptr<void> plan(ptr, [key, made](void *) mutable
+    {
+        {
+            std::lock_guard<std::mutex> lock(getFFTPlanMutex());
+            auto &plans = getFFTPlans();
+            auto it = plans.find(key);
+            if (it != plans.end() and it->second.expired()) plans.erase(it);
+        }
+        made.reset();
+    });
+    plans[key] = plan;
+    return plan;
+}
+
+size_t getFFTPlanCacheSize(void)
+{
+    std::lock_guard<std::mutex> lock(getFFTPlanMutex());
+    return getFFTPlans().size();
+}
@@ -0,0 +1,30 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#pragma once
+#include <Pothos/Config.hpp>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+
+#ifdef CommsFFTPlans_EXPORTS
+#define COMMS_FFT_PLANS_API POTHOS_HELPER_DLL_EXPORT
+#else
+#define COMMS_FFT_PLANS_API POTHOS_HELPER_DLL_IMPORT
+#endif
+
+/***********************************************************************
+ * Process-wide cache of FFT plans, shared by every module that links it.
+ * The plan type name is part of the key, so plans of different types,
+ * like the float, double, and fixed point plans, are kept apart.
+ * A plan is made by make() on the first request of a key,
+ * and freed and removed from the cache with its last user.
+ **********************************************************************/
+COMMS_FFT_PLANS_API std::shared_ptr<void> getFFTPlan(
+    const std::string &planType,
+    const size_t numBins,
+    const bool inverse,
+    const std::function<std::shared_ptr<void>(void)> &make);
+
+//! The number of plans in the cache, which are all in use
+COMMS_FFT_PLANS_API size_t getFFTPlanCacheSize(void);